@@ -0,0 +1,309 @@
+/*
+  ==============================================================================
+
+    BatchRender.cpp
+
+    Offline command-line renderer: streams audio files through
+    NewProjectAudioProcessor in large non-realtime blocks, one processor
+    instance per worker thread, many files in parallel.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    //==============================================================================
+    struct Options
+    {
+        juce::Array<juce::File> inputs;
+        juce::File outputDirectory;
+        juce::File stateFile;
+        juce::StringPairArray parameters;   // parameter ID -> real-world value
+        int numJobs = juce::SystemStats::getNumCpus();
+        int blockSize = 8192;
+        int bitsPerSample = 0;              // 0 = same as the input
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: NewProjectBatchRender [options] <input files or folders...>\n"
+                     "  --out <folder>        where to write the rendered files (required)\n"
+                     "  --param <ID>=<value>  set a parameter, in its own units (e.g. VOL=-6 LPF=2000)\n"
+                     "  --state <file>        load a state blob saved by the plugin before applying --param\n"
+                     "  --jobs <n>            number of worker threads (default: one per CPU)\n"
+                     "  --block <samples>     processing block size (default: 8192)\n"
+                     "  --bits <16|24|32>     output bit depth (default: same as the input)\n";
+    }
+
+    bool parseOptions (const juce::StringArray& args, Options& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            auto hasValue = i + 1 < args.size();
+
+            if (args[i] == "--out" && hasValue)
+                options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (args[++i]);
+            else if (args[i] == "--state" && hasValue)
+                options.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile (args[++i]);
+            else if (args[i] == "--param" && hasValue)
+            {
+                auto assignment = args[++i];
+                options.parameters.set (assignment.upToFirstOccurrenceOf ("=", false, false),
+                                        assignment.fromFirstOccurrenceOf ("=", false, false));
+            }
+            else if (args[i] == "--jobs" && hasValue)
+                options.numJobs = juce::jmax (1, args[++i].getIntValue());
+            else if (args[i] == "--block" && hasValue)
+                options.blockSize = juce::jlimit (64, 1 << 20, args[++i].getIntValue());
+            else if (args[i] == "--bits" && hasValue)
+                options.bitsPerSample = args[++i].getIntValue();
+            else if (args[i].startsWith ("--"))
+                return false;
+            else
+            {
+                auto file = juce::File::getCurrentWorkingDirectory().getChildFile (args[i]);
+
+                if (file.isDirectory())
+                    options.inputs.addArray (file.findChildFiles (juce::File::findFiles, false, "*.wav;*.aif;*.aiff;*.flac"));
+                else
+                    options.inputs.add (file);
+            }
+        }
+
+        return options.outputDirectory != juce::File() && ! options.inputs.isEmpty();
+    }
+
+    //==============================================================================
+    /** Serialises console output from the workers. */
+    class Log
+    {
+    public:
+        void write (const juce::String& message)
+        {
+            const juce::ScopedLock sl (lock);
+            std::cout << message << std::endl;
+        }
+
+    private:
+        juce::CriticalSection lock;
+    };
+
+    //==============================================================================
+    /** Owns one processor instance and renders files from the shared queue
+        until it is empty.
+    */
+    class RenderWorker  : public juce::ThreadPoolJob
+    {
+    public:
+        RenderWorker (const Options& o, const juce::MemoryBlock& state, std::atomic<int>& next,
+                      std::atomic<int>& failed, Log& l)
+            : juce::ThreadPoolJob ("Render worker"), options (o), stateBlob (state),
+              nextInput (next), numFailed (failed), log (l)
+        {
+            formatManager.registerBasicFormats();
+
+            if (! stateBlob.isEmpty())
+                processor.setStateInformation (stateBlob.getData(), (int) stateBlob.getSize());
+
+            parameterError = applyParameters();
+            processor.setNonRealtime (true);
+            processor.setOutputAnalysisEnabled (false); //the renderer reads neither the loudness nor the spectrum
+        }
+
+        JobStatus runJob() override
+        {
+            for (auto index = nextInput++; index < options.inputs.size(); index = nextInput++)
+            {
+                if (shouldExit())
+                    break;
+
+                auto& input = options.inputs.getReference (index);
+                auto error = render (input);
+
+                if (error.isEmpty())
+                {
+                    log.write ("done    " + input.getFullPathName());
+                }
+                else
+                {
+                    ++numFailed;
+                    log.write ("FAILED  " + input.getFullPathName() + ": " + error);
+                }
+            }
+
+            return jobHasFinished;
+        }
+
+    private:
+        /** Returns an error message, or an empty string on success. */
+        juce::String render (const juce::File& input)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (input));
+
+            if (reader == nullptr)
+                return "can't read this file";
+
+            if (parameterError.isNotEmpty())
+                return parameterError;
+
+            auto numChannels = (int) reader->numChannels;
+            auto sampleRate = reader->sampleRate;
+
+            // the worker's processor is re-laid-out for each file; prepareToPlay
+            // clears its DSP state so nothing leaks from one stem into the next
+            juce::AudioProcessor::BusesLayout layout;
+            layout.inputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+            layout.outputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+
+            if (! processor.setBusesLayout (layout))
+                return "unsupported channel count (" + juce::String (numChannels) + ")";
+
+            processor.setRateAndBufferSizeDetails (sampleRate, options.blockSize);
+            processor.prepareToPlay (sampleRate, options.blockSize);
+
+            struct ScopedRelease
+            {
+                ~ScopedRelease()    { p.releaseResources(); }
+                juce::AudioProcessor& p;
+            } release { processor };
+
+            auto outputFile = options.outputDirectory.getChildFile (input.getFileNameWithoutExtension() + ".wav");
+            outputFile.deleteFile();
+
+            auto stream = outputFile.createOutputStream();
+
+            if (stream == nullptr)
+                return "can't create " + outputFile.getFullPathName();
+
+            juce::WavAudioFormat wav;
+            auto bits = options.bitsPerSample > 0 ? options.bitsPerSample : (int) reader->bitsPerSample;
+            std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                                  bits, reader->metadataValues, 0));
+
+            if (writer == nullptr)
+                return "can't write a " + juce::String (bits) + " bit WAV file";
+
+            stream.release(); // now owned by the writer
+
+            juce::AudioBuffer<float> buffer (numChannels, options.blockSize);
+            juce::MidiBuffer midi;
+
+            // skip the processor's latency at the start and flush it out at the end,
+            // so the output lines up with the input
+            auto latency = (juce::int64) processor.getLatencySamples();
+            auto totalOutput = reader->lengthInSamples;
+            juce::int64 readPosition = 0, written = 0, toSkip = latency;
+
+            while (written < totalOutput)
+            {
+                if (shouldExit())
+                    return "cancelled";
+
+                auto numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) options.blockSize, reader->lengthInSamples - readPosition);
+
+                if (numToRead > 0)
+                    reader->read (&buffer, 0, numToRead, readPosition, true, true);
+
+                buffer.clear (numToRead, options.blockSize - numToRead);
+                readPosition += numToRead;
+
+                processor.processBlock (buffer, midi);
+
+                auto start = (int) juce::jmin (toSkip, (juce::int64) options.blockSize);
+                toSkip -= start;
+
+                auto numToWrite = (int) juce::jmin ((juce::int64) (options.blockSize - start), totalOutput - written);
+
+                if (numToWrite > 0 && ! writer->writeFromAudioSampleBuffer (buffer, start, numToWrite))
+                    return "write failed";
+
+                written += juce::jmax (0, numToWrite);
+            }
+
+            return {};
+        }
+
+        juce::String applyParameters()
+        {
+            auto keys = options.parameters.getAllKeys();
+
+            for (auto& id : keys)
+            {
+                auto* parameter = processor.apvts.getParameter (id);
+
+                if (parameter == nullptr)
+                    return "unknown parameter " + id;
+
+                auto value = options.parameters[id].getFloatValue();
+                parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+            }
+
+            return {};
+        }
+
+        const Options& options;
+        const juce::MemoryBlock& stateBlob;
+        std::atomic<int>& nextInput;
+        std::atomic<int>& numFailed;
+        Log& log;
+
+        juce::AudioFormatManager formatManager;
+        NewProjectAudioProcessor processor;
+        juce::String parameterError;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderWorker)
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add (argv[i]);
+
+    Options options;
+
+    if (args.contains ("--help") || ! parseOptions (args, options))
+    {
+        printUsage();
+        return args.contains ("--help") ? 0 : 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::MemoryBlock state;
+
+    if (options.stateFile != juce::File() && ! options.stateFile.loadFileAsData (state))
+    {
+        std::cerr << "Can't read state file " << options.stateFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (! options.outputDirectory.createDirectory())
+    {
+        std::cerr << "Can't create " << options.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto numWorkers = juce::jmin (options.numJobs, options.inputs.size());
+    std::atomic<int> nextInput { 0 }, numFailed { 0 };
+    Log log;
+
+    {
+        juce::ThreadPool pool (numWorkers);
+
+        for (int i = 0; i < numWorkers; ++i)
+            pool.addJob (new RenderWorker (options, state, nextInput, numFailed, log), true);
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep (50);
+    }
+
+    std::cout << (options.inputs.size() - numFailed.load()) << " of " << options.inputs.size() << " files rendered" << std::endl;
+    return numFailed.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,355 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmark.cpp
+
+    Headless micro-benchmark for NewProjectAudioProcessor. Instantiates the
+    processor without an editor and sweeps sample rates, block sizes and
+    channel layouts, with and without parameter changes between blocks.
+    Continuous automation and mode switches are timed as separate cases.
+    There's no message loop, so the processor's timer work is run by hand
+    every tenth of a second of audio, outside the timed region, as a host's
+    message thread would.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#if JUCE_INTEL
+ #include <x86intrin.h>
+#endif
+
+namespace
+{
+    //==============================================================================
+    /** Cycle counter where the CPU has one we can read cheaply, 0 otherwise. */
+    inline juce::uint64 readCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return 0;
+       #endif
+    }
+
+    inline bool hasCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    struct Options
+    {
+        double secondsPerCase = 1.0;
+        int maxBlockSize = 4096;
+        int automationGranularity = NewProjectAudioProcessor::defaultAutomationGranularity;
+        bool csv = false;
+        bool doublePrecision = false;
+    };
+
+    struct Layout
+    {
+        const char* name;
+        juce::AudioChannelSet channels;
+    };
+
+    struct Result
+    {
+        double nsPerSample = 0.0, cyclesPerSample = 0.0;
+        double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0; // microseconds per block
+    };
+
+    double percentile (const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        auto index = (size_t) juce::jlimit (0.0, (double) sorted.size() - 1.0, std::ceil (fraction * (double) sorted.size()) - 1.0);
+        return sorted[index];
+    }
+
+    //==============================================================================
+    enum class Automation
+    {
+        off,        // parameters stay put
+        continuous, // the smoothed parameters move every block, as host automation would
+        modes       // the mode and latency switches flip every block: worst case, not typical use
+    };
+
+    const char* getName (Automation automation) noexcept
+    {
+        switch (automation)
+        {
+            case Automation::continuous:  return "on";
+            case Automation::modes:       return "modes";
+            case Automation::off:
+            default:                      return "off";
+        }
+    }
+
+    /** The parameters that glide rather than switch the processing around. */
+    bool isContinuous (const juce::String& parameterID)
+    {
+        static const juce::StringArray ids { "LPF", "VOL", "LFORATE", "LFODEPTH", "LIMREL",
+                                             "XOVER1", "XOVER2", "XOVER3", "XOVER4",
+                                             "BGAIN1", "BGAIN2", "BGAIN3", "BGAIN4", "BGAIN5" };
+        return ids.contains (parameterID);
+    }
+
+    /** Moves either the continuous parameters or the mode switches to new random values. */
+    void randomiseParameters (NewProjectAudioProcessor& processor, Automation automation, juce::Random& random)
+    {
+        for (auto* parameter : processor.getParameters())
+        {
+            if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+                if (isContinuous (withID->paramID) == (automation == Automation::continuous))
+                    parameter->setValueNotifyingHost (random.nextFloat());
+        }
+    }
+
+    bool configure (NewProjectAudioProcessor& processor, const Layout& layout, double sampleRate, int blockSize)
+    {
+        juce::AudioProcessor::BusesLayout buses;
+        buses.inputBuses.add (layout.channels);
+        buses.outputBuses.add (layout.channels);
+
+        if (! processor.setBusesLayout (buses))
+            return false;
+
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+        return true;
+    }
+
+    template <typename SampleType>
+    Result runCase (NewProjectAudioProcessor& processor, int numChannels, double sampleRate,
+                    int blockSize, Automation automation, const Options& options)
+    {
+        juce::Random random (0x1234);
+
+        // a second of noise, copied into the work buffer outside the timed region
+        juce::AudioBuffer<SampleType> source (numChannels, (int) sampleRate);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < source.getNumSamples(); ++i)
+                source.setSample (channel, i, (SampleType) (random.nextFloat() * 2.0f - 1.0f));
+
+        juce::AudioBuffer<SampleType> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        auto totalSamples = juce::jmax ((juce::int64) blockSize, (juce::int64) (options.secondsPerCase * sampleRate));
+        auto numBlocks = (int) (totalSamples / blockSize);
+        int readPosition = 0;
+
+        // the processor's 10 Hz timer, in audio time
+        const auto samplesPerTimerTick = juce::jmax (1, (int) (sampleRate / 10.0));
+        int samplesSinceTimerTick = 0;
+
+        auto runTimerIfDue = [&]
+        {
+            samplesSinceTimerTick += blockSize;
+
+            if (samplesSinceTimerTick >= samplesPerTimerTick)
+            {
+                samplesSinceTimerTick = 0;
+                processor.runTimerTasks();
+            }
+        };
+
+        auto fillBlock = [&]
+        {
+            if (readPosition + blockSize > source.getNumSamples())
+                readPosition = 0;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.copyFrom (channel, 0, source, channel, readPosition, blockSize);
+
+            readPosition += blockSize;
+        };
+
+        // warm up caches, branch predictors and the gain smoother
+        for (int i = 0; i < juce::jmin (numBlocks, 64); ++i)
+        {
+            fillBlock();
+            processor.processBlock (buffer, midi);
+            runTimerIfDue();
+        }
+
+        std::vector<double> blockTimes;
+        blockTimes.reserve ((size_t) numBlocks);
+
+        juce::int64 totalTicks = 0;
+        juce::uint64 totalCycles = 0;
+        const auto secondsPerTick = 1.0 / (double) juce::Time::getHighResolutionTicksPerSecond();
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            fillBlock();
+
+            if (automation != Automation::off)
+                randomiseParameters (processor, automation, random);
+
+            auto startCycles = readCycleCounter();
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            processor.processBlock (buffer, midi);
+
+            auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+            totalCycles += readCycleCounter() - startCycles;
+            totalTicks += ticks;
+
+            blockTimes.push_back ((double) ticks * secondsPerTick * 1.0e6);
+
+            runTimerIfDue();
+        }
+
+        std::sort (blockTimes.begin(), blockTimes.end());
+
+        auto samplesProcessed = (double) numBlocks * (double) blockSize;
+
+        Result result;
+        result.nsPerSample = (double) totalTicks * secondsPerTick * 1.0e9 / samplesProcessed;
+        result.cyclesPerSample = (double) totalCycles / samplesProcessed;
+        result.p50 = percentile (blockTimes, 0.50);
+        result.p90 = percentile (blockTimes, 0.90);
+        result.p99 = percentile (blockTimes, 0.99);
+        result.max = blockTimes.empty() ? 0.0 : blockTimes.back();
+        return result;
+    }
+
+    //==============================================================================
+    /** Times the non-block entry points on their own. */
+    void runMicroBenchmarks (const Options& options)
+    {
+        NewProjectAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails (48000.0, 512);
+        processor.prepareToPlay (48000.0, 512);
+
+        auto timeIt = [&] (const char* name, int iterations, std::function<void()> function)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < iterations; ++i)
+                function();
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            std::cout << (options.csv ? "" : "  ") << name << (options.csv ? "," : ": ")
+                      << juce::String (seconds * 1.0e9 / iterations, 1) << (options.csv ? "\n" : " ns/call\n");
+        };
+
+        std::cout << (options.csv ? "function,ns_per_call\n" : "Micro-benchmarks\n");
+
+        timeIt ("update", 100000, [&] { processor.update(); });
+        timeIt ("createParameters", 2000, [&] { auto layout = processor.createParameters(); juce::ignoreUnused (layout); });
+
+        std::cout << std::endl;
+    }
+
+    Options parseOptions (const juce::StringArray& args)
+    {
+        Options options;
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            if (args[i] == "--seconds" && i + 1 < args.size())
+                options.secondsPerCase = juce::jmax (0.01, args[++i].getDoubleValue());
+            else if (args[i] == "--max-block" && i + 1 < args.size())
+                options.maxBlockSize = juce::jlimit (1, 4096, args[++i].getIntValue());
+            else if (args[i] == "--granularity" && i + 1 < args.size())
+                options.automationGranularity = juce::jmax (0, args[++i].getIntValue());
+            else if (args[i] == "--double")
+                options.doublePrecision = true;
+            else if (args[i] == "--csv")
+                options.csv = true;
+        }
+
+        return options;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add (argv[i]);
+
+    if (args.contains ("--help"))
+    {
+        std::cout << "Usage: NewProjectBenchmark [--seconds <audio seconds per case>] [--max-block <samples>] [--granularity <samples, 0 = host block>] [--double] [--csv]\n";
+        return 0;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    auto options = parseOptions (args);
+
+    runMicroBenchmarks (options);
+
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+
+    const Layout layouts[] = { { "mono",   juce::AudioChannelSet::mono() },
+                               { "stereo", juce::AudioChannelSet::stereo() },
+                               { "5.1",    juce::AudioChannelSet::create5point1() },
+                               { "7.1.4",  juce::AudioChannelSet::create7point1point4() },
+                               { "ambi3",  juce::AudioChannelSet::ambisonic (3) } };
+
+    if (options.csv)
+        std::cout << "rate,block,layout,automation,ns_per_sample,cycles_per_sample,p50_us,p90_us,p99_us,max_us\n";
+    else
+        std::cout << "rate    block  layout   automation   ns/sample  cycles/sample   p50 us   p90 us   p99 us   max us\n";
+
+    for (auto sampleRate : sampleRates)
+    {
+        for (int blockSize = 1; blockSize <= options.maxBlockSize; blockSize *= 2)
+        {
+            for (auto& layout : layouts)
+            {
+                for (auto automation : { Automation::off, Automation::continuous, Automation::modes })
+                {
+                    NewProjectAudioProcessor processor;
+                    processor.setAutomationGranularity (options.automationGranularity);
+                    processor.setProcessingPrecision (options.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                              : juce::AudioProcessor::singlePrecision);
+
+                    if (! configure (processor, layout, sampleRate, blockSize))
+                        continue;
+
+                    auto result = options.doublePrecision
+                                    ? runCase<double> (processor, layout.channels.size(), sampleRate, blockSize, automation, options)
+                                    : runCase<float>  (processor, layout.channels.size(), sampleRate, blockSize, automation, options);
+                    processor.releaseResources();
+
+                    auto cycles = hasCycleCounter() ? juce::String (result.cyclesPerSample, 2) : juce::String ("n/a");
+
+                    if (options.csv)
+                    {
+                        std::cout << sampleRate << ',' << blockSize << ',' << layout.name << ',' << getName (automation) << ','
+                                  << result.nsPerSample << ',' << cycles << ',' << result.p50 << ','
+                                  << result.p90 << ',' << result.p99 << ',' << result.max << '\n';
+                    }
+                    else
+                    {
+                        std::cout << juce::String (sampleRate, 0).paddedRight (' ', 8)
+                                  << juce::String (blockSize).paddedRight (' ', 7)
+                                  << juce::String (layout.name).paddedRight (' ', 9)
+                                  << juce::String (getName (automation)).paddedRight (' ', 13)
+                                  << juce::String (result.nsPerSample, 2).paddedRight (' ', 11)
+                                  << cycles.paddedRight (' ', 16)
+                                  << juce::String (result.p50, 2).paddedRight (' ', 9)
+                                  << juce::String (result.p90, 2).paddedRight (' ', 9)
+                                  << juce::String (result.p99, 2).paddedRight (' ', 9)
+                                  << juce::String (result.max, 2) << '\n';
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
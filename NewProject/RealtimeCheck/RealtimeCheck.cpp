@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+
+    Runs NewProjectAudioProcessor through every layout, block size, precision
+    and parameter combination a host can throw at it, with each processBlock
+    call inside a real-time section. Any allocation, lock or blocking call
+    made from processBlock is reported with a stack trace, and the exit code
+    is non-zero, so CI catches it before it becomes an xrun on a session.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "RealtimeSanitizer.h"
+
+namespace
+{
+    //==============================================================================
+    struct Layout
+    {
+        const char* name;
+        juce::AudioChannelSet channels;
+    };
+
+    /** Stands in for the plugin wrapper, which always listens to the processor:
+        without a listener, host notifications would skip their locks.
+    */
+    struct HostListener  : public juce::AudioProcessorListener
+    {
+        void audioProcessorParameterChanged (juce::AudioProcessor*, int, float) override {}
+        void audioProcessorChanged (juce::AudioProcessor*, const ChangeDetails&) override {}
+    };
+
+    /** Returns the number of violations this case produced. */
+    template <typename SampleType>
+    int runCase (const Layout& layout, double sampleRate, int maxBlockSize, int numBlocks)
+    {
+        NewProjectAudioProcessor processor;
+        HostListener host;
+        processor.addListener (&host);
+
+        processor.setProcessingPrecision (std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                  : juce::AudioProcessor::singlePrecision);
+
+        juce::AudioProcessor::BusesLayout buses;
+        buses.inputBuses.add (layout.channels);
+        buses.outputBuses.add (layout.channels);
+
+        if (! processor.setBusesLayout (buses))
+        {
+            processor.removeListener (&host);
+            return 0;
+        }
+
+        processor.setRateAndBufferSizeDetails (sampleRate, maxBlockSize);
+        processor.prepareToPlay (sampleRate, maxBlockSize);
+
+        juce::Random random (0x5eed);
+        juce::AudioBuffer<SampleType> buffer (layout.channels.size(), maxBlockSize);
+        juce::MidiBuffer midi;
+
+        auto violationsBefore = RealtimeSanitizer::getNumViolations();
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            // hosts may pass any block size up to the prepared one
+            auto numSamples = (i % 3 == 0) ? maxBlockSize : 1 + random.nextInt (maxBlockSize);
+            buffer.setSize (buffer.getNumChannels(), numSamples, false, false, true);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int sample = 0; sample < numSamples; ++sample)
+                    buffer.setSample (channel, sample, (SampleType) (random.nextFloat() * 4.0f - 2.0f));
+
+            // parameter moves arrive from the message thread, outside the section
+            if (i % 2 == 0)
+                for (auto* parameter : processor.getParameters())
+                    if (random.nextInt (4) == 0)
+                        parameter->setValueNotifyingHost (random.nextFloat());
+
+            {
+                const RealtimeSanitizer::ScopedRealtimeSection realtime;
+                processor.processBlock (buffer, midi);
+            }
+        }
+
+        processor.releaseResources();
+        processor.removeListener (&host);
+
+        return RealtimeSanitizer::getNumViolations() - violationsBefore;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add (argv[i]);
+
+    if (args.contains ("--help"))
+    {
+        std::cout << "Usage: NewProjectRealtimeCheck [--blocks <per case>] [--max-reports <n>]\n";
+        return 0;
+    }
+
+    auto numBlocks = 2000;
+
+    for (int i = 0; i + 1 < args.size(); ++i)
+    {
+        if (args[i] == "--blocks")
+            numBlocks = juce::jmax (1, args[i + 1].getIntValue());
+        else if (args[i] == "--max-reports")
+            RealtimeSanitizer::setMaxReports (args[i + 1].getIntValue());
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const Layout layouts[] = { { "mono",   juce::AudioChannelSet::mono() },
+                               { "stereo", juce::AudioChannelSet::stereo() },
+                               { "5.1",    juce::AudioChannelSet::create5point1() },
+                               { "7.1.4",  juce::AudioChannelSet::create7point1point4() },
+                               { "ambi3",  juce::AudioChannelSet::ambisonic (3) } };
+
+    const int blockSizes[] = { 1, 31, 64, 480, 4096 };
+
+    for (auto& layout : layouts)
+    {
+        for (auto blockSize : blockSizes)
+        {
+            for (auto doublePrecision : { false, true })
+            {
+                auto numViolations = doublePrecision ? runCase<double> (layout, 48000.0, blockSize, numBlocks)
+                                                     : runCase<float>  (layout, 48000.0, blockSize, numBlocks);
+
+                std::cout << juce::String (layout.name).paddedRight (' ', 8)
+                          << juce::String (blockSize).paddedRight (' ', 6)
+                          << (doublePrecision ? "double  " : "float   ")
+                          << (numViolations == 0 ? juce::String ("ok") : juce::String (numViolations) + " violations")
+                          << std::endl;
+            }
+        }
+    }
+
+    auto total = RealtimeSanitizer::getNumViolations();
+    std::cout << (total == 0 ? "No real-time violations" : juce::String (total) + " real-time violations") << std::endl;
+    return total == 0 ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+    RealtimeSanitizer.cpp
+
+    Defining these functions in the executable overrides the C library's
+    versions for every module loaded by it (ELF symbol interposition), so the
+    JUCE code and the C++ runtime are covered as well as our own. The real
+    allocator is reached through glibc's __libc_* entry points, everything
+    else through dlsym (RTLD_NEXT).
+
+    Must be linked into an executable, not a shared library or plugin.
+
+  ==============================================================================
+*/
+
+#include "RealtimeSanitizer.h"
+
+#if ! defined (__linux__)
+ #error "The real-time sanitizer relies on glibc symbol interposition and only builds on Linux"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void  __libc_free (void*);
+}
+
+namespace
+{
+    thread_local int realtimeDepth = 0;
+    thread_local bool isReporting = false;
+
+    std::atomic<int> numViolations { 0 };
+    std::atomic<int> maxReports { 20 };
+
+    /** Prints without allocating: snprintf into a stack buffer, then write(2). */
+    void report (const char* what)
+    {
+        auto index = numViolations++;
+
+        if (index >= maxReports.load())
+            return;
+
+        char message[256];
+        auto length = std::snprintf (message, sizeof (message),
+                                     "\n*** real-time violation #%d: %s called inside a real-time section\n", index + 1, what);
+        ::write (STDERR_FILENO, message, (size_t) length);
+
+        void* frames[64];
+        auto numFrames = ::backtrace (frames, 64);
+        ::backtrace_symbols_fd (frames + 2, numFrames - 2, STDERR_FILENO);   // skip report() and the interposer
+    }
+
+    /** Reports if the calling thread is in a real-time section, ignoring calls
+        made by the reporting itself.
+    */
+    inline void check (const char* what)
+    {
+        if (realtimeDepth > 0 && ! isReporting)
+        {
+            isReporting = true;
+            report (what);
+            isReporting = false;
+        }
+    }
+
+    /** The next definition of an interposed function, looked up once. Plain
+        atomics rather than function-local statics, whose guards can lock.
+    */
+    template <typename FunctionType>
+    FunctionType getNext (std::atomic<FunctionType>& cache, const char* name, const char* version = nullptr)
+    {
+        auto function = cache.load (std::memory_order_relaxed);
+
+        if (function == nullptr)
+        {
+            // plain dlsym would give the pre-2.3.2 condition variable ABI
+            function = reinterpret_cast<FunctionType> (version != nullptr ? ::dlvsym (RTLD_NEXT, name, version)
+                                                                          : ::dlsym (RTLD_NEXT, name));
+            cache.store (function, std::memory_order_relaxed);
+        }
+
+        return function;
+    }
+
+    std::atomic<int (*) (pthread_mutex_t*)> nextMutexLock { nullptr };
+    std::atomic<int (*) (pthread_rwlock_t*)> nextRwlockRdlock { nullptr }, nextRwlockWrlock { nullptr };
+    std::atomic<int (*) (pthread_cond_t*, pthread_mutex_t*)> nextCondWait { nullptr };
+    std::atomic<int (*) (pthread_cond_t*, pthread_mutex_t*, const struct timespec*)> nextCondTimedwait { nullptr };
+    std::atomic<int (*) (pthread_t, void**)> nextJoin { nullptr };
+    std::atomic<int (*) (sem_t*)> nextSemWait { nullptr };
+    std::atomic<int (*) (const struct timespec*, struct timespec*)> nextNanosleep { nullptr };
+    std::atomic<int (*) (useconds_t)> nextUsleep { nullptr };
+    std::atomic<unsigned int (*) (unsigned int)> nextSleep { nullptr };
+
+    struct Warmup
+    {
+        Warmup()
+        {
+            // backtrace() loads libgcc and allocates the first time it runs,
+            // and dlsym can allocate too, so do both before any section starts
+            void* frames[4];
+            ::backtrace (frames, 4);
+
+            getNext (nextMutexLock, "pthread_mutex_lock");
+            getNext (nextRwlockRdlock, "pthread_rwlock_rdlock");
+            getNext (nextRwlockWrlock, "pthread_rwlock_wrlock");
+            getNext (nextCondWait, "pthread_cond_wait", "GLIBC_2.3.2");
+            getNext (nextCondTimedwait, "pthread_cond_timedwait", "GLIBC_2.3.2");
+            getNext (nextJoin, "pthread_join");
+            getNext (nextSemWait, "sem_wait");
+            getNext (nextNanosleep, "nanosleep");
+            getNext (nextUsleep, "usleep");
+            getNext (nextSleep, "sleep");
+        }
+    };
+
+    const Warmup warmup;
+}
+
+//==============================================================================
+namespace RealtimeSanitizer
+{
+    ScopedRealtimeSection::ScopedRealtimeSection() noexcept     { ++realtimeDepth; }
+    ScopedRealtimeSection::~ScopedRealtimeSection() noexcept    { --realtimeDepth; }
+
+    int getNumViolations() noexcept                 { return numViolations.load(); }
+    void setMaxReports (int newMaxReports) noexcept { maxReports = newMaxReports; }
+}
+
+//==============================================================================
+// heap (operator new and delete end up here through libstdc++)
+extern "C"
+{
+    void* malloc (size_t size)
+    {
+        check ("malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size)
+    {
+        check ("calloc");
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* pointer, size_t size)
+    {
+        check ("realloc");
+        return __libc_realloc (pointer, size);
+    }
+
+    void* memalign (size_t alignment, size_t size)
+    {
+        check ("memalign");
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size)
+    {
+        check ("aligned_alloc");
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size)
+    {
+        check ("posix_memalign");
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr || size == 0 ? 0 : 12 /* ENOMEM */;
+    }
+
+    void free (void* pointer)
+    {
+        if (pointer != nullptr)
+            check ("free");
+
+        __libc_free (pointer);
+    }
+
+    //==============================================================================
+    // locks and waits
+    int pthread_mutex_lock (pthread_mutex_t* mutex)
+    {
+        auto next = getNext (nextMutexLock, "pthread_mutex_lock");
+        check ("pthread_mutex_lock");
+        return next (mutex);
+    }
+
+    int pthread_rwlock_rdlock (pthread_rwlock_t* lock)
+    {
+        auto next = getNext (nextRwlockRdlock, "pthread_rwlock_rdlock");
+        check ("pthread_rwlock_rdlock");
+        return next (lock);
+    }
+
+    int pthread_rwlock_wrlock (pthread_rwlock_t* lock)
+    {
+        auto next = getNext (nextRwlockWrlock, "pthread_rwlock_wrlock");
+        check ("pthread_rwlock_wrlock");
+        return next (lock);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        auto next = getNext (nextCondWait, "pthread_cond_wait", "GLIBC_2.3.2");
+        check ("pthread_cond_wait");
+        return next (condition, mutex);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        auto next = getNext (nextCondTimedwait, "pthread_cond_timedwait", "GLIBC_2.3.2");
+        check ("pthread_cond_timedwait");
+        return next (condition, mutex, time);
+    }
+
+    int pthread_join (pthread_t thread, void** result)
+    {
+        auto next = getNext (nextJoin, "pthread_join");
+        check ("pthread_join");
+        return next (thread, result);
+    }
+
+    int sem_wait (sem_t* semaphore)
+    {
+        auto next = getNext (nextSemWait, "sem_wait");
+        check ("sem_wait");
+        return next (semaphore);
+    }
+
+    //==============================================================================
+    // sleeping
+    int nanosleep (const struct timespec* duration, struct timespec* remaining)
+    {
+        auto next = getNext (nextNanosleep, "nanosleep");
+        check ("nanosleep");
+        return next (duration, remaining);
+    }
+
+    int usleep (useconds_t microseconds)
+    {
+        auto next = getNext (nextUsleep, "usleep");
+        check ("usleep");
+        return next (microseconds);
+    }
+
+    unsigned int sleep (unsigned int seconds)
+    {
+        auto next = getNext (nextSleep, "sleep");
+        check ("sleep");
+        return next (seconds);
+    }
+}
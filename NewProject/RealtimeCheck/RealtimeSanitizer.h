@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    RealtimeSanitizer.h
+
+    Flags heap allocations, lock acquisitions and blocking calls made by a
+    thread while it is inside a real-time section. RealtimeSanitizer.cpp
+    interposes malloc & co, the pthread locking and waiting functions and
+    the sleep calls (Linux / glibc only); each violation prints the call
+    and a stack trace to stderr.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace RealtimeSanitizer
+{
+    /** Marks the calling thread as real-time until destruction. Nestable. */
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() noexcept;
+        ~ScopedRealtimeSection() noexcept;
+
+        ScopedRealtimeSection (const ScopedRealtimeSection&) = delete;
+        ScopedRealtimeSection& operator= (const ScopedRealtimeSection&) = delete;
+    };
+
+    /** Number of violations reported since the program started. */
+    int getNumViolations() noexcept;
+
+    /** Limits how many violations print a stack trace; later ones are only counted. */
+    void setMaxReports (int maxReports) noexcept;
+}
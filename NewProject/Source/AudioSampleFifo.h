@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    AudioSampleFifo.h
+
+    Single-producer / single-consumer ring of multichannel float samples, for
+    handing audio from the audio thread to an analysis thread. Pushing is a
+    plain copy into preallocated memory; it never locks or allocates.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class AudioSampleFifo
+{
+public:
+    AudioSampleFifo() = default;
+
+    /** Allocates the ring. Neither side may be using the FIFO while this runs. */
+    void prepare (int numChannels, int capacityInSamples)
+    {
+        buffer.setSize (juce::jmax (1, numChannels), juce::jmax (2, capacityInSamples));
+        buffer.clear();
+        fifo.setTotalSize (buffer.getNumSamples());
+        fifo.reset();
+    }
+
+    int getNumChannels() const noexcept     { return buffer.getNumChannels(); }
+
+    /** Either side. Number of samples queued and not popped yet. */
+    int getNumReady() const noexcept        { return fifo.getNumReady(); }
+
+    /** Producer only. Copies as much of the block as fits and returns the number
+        of samples written; the rest is dropped if the consumer has fallen behind.
+    */
+    template <typename SampleType>
+    int push (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* dest = buffer.getWritePointer (channel);
+
+            if (channel < numChannels)
+            {
+                copySamples (dest + start1, channels[channel], size1);
+                copySamples (dest + start2, channels[channel] + size1, size2);
+            }
+            else
+            {
+                juce::FloatVectorOperations::clear (dest + start1, size1);
+                juce::FloatVectorOperations::clear (dest + start2, size2);
+            }
+        }
+
+        fifo.finishedWrite (size1 + size2);
+        return size1 + size2;
+    }
+
+    /** Consumer only. Moves up to maxSamples of the oldest samples to the start
+        of dest, which must have at least getNumChannels() channels, and returns
+        how many were moved.
+    */
+    int pop (juce::AudioBuffer<float>& dest, int maxSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (juce::jmin (maxSamples, dest.getNumSamples()), start1, size1, start2, size2);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            if (size1 > 0)
+                dest.copyFrom (channel, 0, buffer, channel, start1, size1);
+
+            if (size2 > 0)
+                dest.copyFrom (channel, size1, buffer, channel, start2, size2);
+        }
+
+        fifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+    /** Consumer only. Throws away everything queued so far. */
+    void discard() noexcept
+    {
+        fifo.finishedRead (fifo.getNumReady());
+    }
+
+private:
+    static void copySamples (float* dest, const float* src, int numSamples) noexcept
+    {
+        juce::FloatVectorOperations::copy (dest, src, numSamples);
+    }
+
+    static void copySamples (float* dest, const double* src, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = (float) src[i];
+    }
+
+    juce::AbstractFifo fifo { 2 };
+    juce::AudioBuffer<float> buffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioSampleFifo)
+};
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    BlockSmoother.cpp
+
+  ==============================================================================
+*/
+
+#include "BlockSmoother.h"
+
+//==============================================================================
+template <typename FloatType>
+void BlockSmoother<FloatType>::prepare (double newSampleRate, int maxBlockSize, Curve newCurve, double smoothingSeconds)
+{
+    curve = newCurve;
+    rampLength = juce::jmax (0, (int) std::floor (smoothingSeconds * newSampleRate));
+
+    ramp.assign ((size_t) juce::jmax (1, maxBlockSize), FloatType (0));
+    setCurrentAndTargetValue (target);
+}
+
+template <typename FloatType>
+void BlockSmoother<FloatType>::setCurrentAndTargetValue (FloatType newValue) noexcept
+{
+    current = target = newValue;
+    countdown = 0;
+}
+
+template <typename FloatType>
+void BlockSmoother<FloatType>::setTargetValue (FloatType newValue) noexcept
+{
+    if (newValue == target)
+        return;
+
+    target = newValue;
+
+    if (rampLength <= 0 || current == target)
+    {
+        setCurrentAndTargetValue (newValue);
+        return;
+    }
+
+    countdown = rampLength;
+
+    // a ratio needs both ends on the same side of zero
+    auto canUseRatio = (current > 0 && target > 0) || (current < 0 && target < 0);
+    glideCurve = curve == multiplicative && ! canUseRatio ? linear : curve;
+
+    if (glideCurve == multiplicative)
+        step = (FloatType) std::exp (std::log ((double) target / (double) current) / rampLength);
+    else if (glideCurve == onePole)
+        step = (FloatType) std::exp (std::log (1.0e-4) / rampLength);   // -80 dB after rampLength samples
+    else
+        step = (target - current) / (FloatType) rampLength;
+}
+
+template <typename FloatType>
+const FloatType* BlockSmoother<FloatType>::getNextBlock (int numSamples) noexcept
+{
+    if (countdown <= 0)
+        return nullptr;
+
+    jassert (numSamples <= getMaxBlockSize());
+    numSamples = juce::jmin (numSamples, getMaxBlockSize());
+
+    auto* dest = ramp.data();
+    auto numRamped = juce::jmin (numSamples, countdown);
+
+    if (glideCurve == linear)
+    {
+        fillArithmetic (dest, current + step, step, numRamped);
+    }
+    else if (glideCurve == multiplicative)
+    {
+        fillGeometric (dest, current * step, step, numRamped);
+    }
+    else
+    {
+        // the distance to the target shrinks geometrically
+        fillGeometric (dest, (current - target) * step, step, numRamped);
+        juce::FloatVectorOperations::add (dest, target, numRamped);
+    }
+
+    countdown -= numRamped;
+
+    if (countdown > 0)
+    {
+        current = dest[numRamped - 1];
+    }
+    else
+    {
+        current = target;
+        dest[numRamped - 1] = target;
+        juce::FloatVectorOperations::fill (dest + numRamped, target, numSamples - numRamped);
+    }
+
+    return dest;
+}
+
+template <typename FloatType>
+FloatType BlockSmoother<FloatType>::skip (int numSamples) noexcept
+{
+    if (countdown <= 0)
+        return current;
+
+    auto numRamped = juce::jmin (numSamples, countdown);
+    countdown -= numRamped;
+
+    if (countdown <= 0)
+        current = target;
+    else if (glideCurve == linear)
+        current += step * (FloatType) numRamped;
+    else if (glideCurve == multiplicative)
+        current *= (FloatType) std::pow ((double) step, numRamped);
+    else
+        current = target + (current - target) * (FloatType) std::pow ((double) step, numRamped);
+
+    return current;
+}
+
+//==============================================================================
+template <typename FloatType>
+void BlockSmoother<FloatType>::fillArithmetic (FloatType* dest, FloatType first, FloatType step, int numValues) noexcept
+{
+    if (numValues <= 0)
+        return;
+
+    dest[0] = first;
+
+    // dest[n + i] = dest[i] + n * step, doubling n every pass
+    for (int numDone = 1; numDone < numValues; numDone *= 2)
+    {
+        auto numToDo = juce::jmin (numDone, numValues - numDone);
+        juce::FloatVectorOperations::copy (dest + numDone, dest, numToDo);
+        juce::FloatVectorOperations::add (dest + numDone, step * (FloatType) numDone, numToDo);
+    }
+}
+
+template <typename FloatType>
+void BlockSmoother<FloatType>::fillGeometric (FloatType* dest, FloatType first, FloatType ratio, int numValues) noexcept
+{
+    if (numValues <= 0)
+        return;
+
+    dest[0] = first;
+    auto factor = ratio;   // ratio^numDone
+
+    // dest[n + i] = dest[i] * ratio^n, doubling n every pass
+    for (int numDone = 1; numDone < numValues; numDone *= 2)
+    {
+        auto numToDo = juce::jmin (numDone, numValues - numDone);
+        juce::FloatVectorOperations::copyWithMultiply (dest + numDone, dest, factor, numToDo);
+        factor *= factor;
+    }
+}
+
+//==============================================================================
+template class BlockSmoother<float>;
+template class BlockSmoother<double>;
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    BlockSmoother.h
+
+    Parameter smoothing that works a block at a time. Instead of stepping a
+    smoothed value per sample, it writes the whole ramp for a block into a
+    buffer with vectorised fills (the ramp is built by doubling: each pass
+    copies the part already written, offset or scaled, with one
+    FloatVectorOperations call), and does nothing at all once the target has
+    been reached.
+
+    Every curve reaches its target in the smoothing time:
+        linear          constant step
+        multiplicative  constant ratio, i.e. linear in dB; values must be > 0
+        onePole         exponential approach, snapped once within -80 dB
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+template <typename FloatType>
+class BlockSmoother
+{
+public:
+    BlockSmoother() = default;
+
+    enum Curve
+    {
+        linear = 0,
+        multiplicative,
+        onePole
+    };
+
+    /** Allocates the ramp buffer for blocks of up to maxBlockSize samples.
+        Must not be called from the audio thread.
+    */
+    void prepare (double sampleRate, int maxBlockSize, Curve newCurve, double smoothingSeconds);
+
+    /** Jumps to newValue. */
+    void setCurrentAndTargetValue (FloatType newValue) noexcept;
+
+    /** Starts a glide from the current value to newValue. */
+    void setTargetValue (FloatType newValue) noexcept;
+
+    FloatType getCurrentValue() const noexcept  { return current; }
+    FloatType getTargetValue() const noexcept   { return target; }
+    bool isSmoothing() const noexcept           { return countdown > 0; }
+
+    /** The values for the next numSamples samples, or nullptr when the value is
+        settled and getCurrentValue() holds for the whole block. numSamples must
+        not be larger than the block size passed to prepare().
+    */
+    const FloatType* getNextBlock (int numSamples) noexcept;
+
+    /** Advances by numSamples without writing the ramp, for values that are only
+        read once per block. Returns the value at the end of the block.
+    */
+    FloatType skip (int numSamples) noexcept;
+
+    int getMaxBlockSize() const noexcept        { return (int) ramp.size(); }
+
+private:
+    /** dest[i] = first + i * step */
+    static void fillArithmetic (FloatType* dest, FloatType first, FloatType step, int numValues) noexcept;
+
+    /** dest[i] = first * ratio^i */
+    static void fillGeometric (FloatType* dest, FloatType first, FloatType ratio, int numValues) noexcept;
+
+    Curve curve = linear, glideCurve = linear;   // glideCurve falls back to linear when a ratio can't work
+    int rampLength = 0;
+
+    FloatType current = 0, target = 0;
+    FloatType step = 0;     // added (linear) or multiplied (multiplicative, onePole) per sample
+    int countdown = 0;
+
+    std::vector<FloatType> ramp;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BlockSmoother)
+};
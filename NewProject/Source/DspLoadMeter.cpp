@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    DspLoadMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "DspLoadMeter.h"
+
+//==============================================================================
+DspLoadMeter::Stats DspLoadMeter::getStats() const noexcept
+{
+    Stats stats;
+
+    std::array<juce::uint32, numBins> counts;
+    juce::int64 total = 0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        counts[(size_t) bin] = bins[(size_t) bin].load (std::memory_order_relaxed);
+        total += counts[(size_t) bin];
+    }
+
+    if (total == 0)
+        return stats;
+
+    // upper edge of the bin the percentile falls in
+    auto percentile = [&] (double fraction)
+    {
+        auto target = (juce::int64) std::ceil (fraction * (double) total);
+        juce::int64 seen = 0;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            seen += counts[(size_t) bin];
+
+            if (seen >= target)
+                return (float) (bin + 1) / binsPerUnitLoad;
+        }
+
+        return (float) numBins / binsPerUnitLoad;
+    };
+
+    stats.p50 = percentile (0.50);
+    stats.p99 = percentile (0.99);
+    stats.max = maxLoad.load (std::memory_order_relaxed);
+    stats.numBlocks = numBlocks.load (std::memory_order_relaxed);
+    stats.numOverruns = numOverruns.load (std::memory_order_relaxed);
+    stats.maxUpdateMilliseconds = juce::Time::highResolutionTicksToSeconds (maxUpdateTicks.load (std::memory_order_relaxed)) * 1000.0;
+
+    return stats;
+}
+
+//==============================================================================
+void DspLoadMeter::addBlock (juce::int64 ticks, int numSamples) noexcept
+{
+    clearIfRequested();
+
+    if (numSamples <= 0 || ticksPerSample <= 0.0)
+        return;
+
+    auto load = (float) ((double) ticks / (ticksPerSample * numSamples));
+    auto bin = juce::jlimit (0, numBins - 1, (int) (load * binsPerUnitLoad));
+
+    increment (bins[(size_t) bin], (juce::uint32) 1);
+    increment (numBlocks, (juce::int64) 1);
+
+    if (load > 1.0f)
+        increment (numOverruns, (juce::int64) 1);
+
+    if (load > maxLoad.load (std::memory_order_relaxed))
+        maxLoad.store (load, std::memory_order_relaxed);
+}
+
+void DspLoadMeter::addUpdate (juce::int64 ticks) noexcept
+{
+    if (ticks > maxUpdateTicks.load (std::memory_order_relaxed))
+        maxUpdateTicks.store (ticks, std::memory_order_relaxed);
+}
+
+void DspLoadMeter::clearIfRequested() noexcept
+{
+    if (! resetRequested.load (std::memory_order_relaxed) || ! resetRequested.exchange (false))
+        return;
+
+    for (auto& bin : bins)
+        bin.store (0, std::memory_order_relaxed);
+
+    numBlocks.store (0, std::memory_order_relaxed);
+    numOverruns.store (0, std::memory_order_relaxed);
+    maxUpdateTicks.store (0, std::memory_order_relaxed);
+    maxLoad.store (0.0f, std::memory_order_relaxed);
+}
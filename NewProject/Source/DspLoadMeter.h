@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    DspLoadMeter.h
+
+    Per-block processing cost relative to the real-time budget
+    (numSamples / sampleRate), kept as a histogram the audio thread writes
+    with plain relaxed stores and any other thread can read for percentiles.
+    A measurement is two high-resolution tick reads and a few stores.
+
+    Define NEWPROJECT_DSP_LOAD_METER=0 in the project's preprocessor
+    definitions to compile the measurements out; the statistics then stay empty.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef NEWPROJECT_DSP_LOAD_METER
+ #define NEWPROJECT_DSP_LOAD_METER 1
+#endif
+
+//==============================================================================
+/**
+*/
+class DspLoadMeter
+{
+public:
+    DspLoadMeter() = default;
+
+    /** Loads are fractions of the budget: 1.0 means the block took exactly as
+        long as it lasts, anything above is an overrun.
+    */
+    struct Stats
+    {
+        float p50 = 0.0f, p99 = 0.0f, max = 0.0f;
+        juce::int64 numBlocks = 0, numOverruns = 0;
+        double maxUpdateMilliseconds = 0.0;     // slowest parameter update
+    };
+
+    /** Call before processing starts. Not thread safe with the audio thread. */
+    void prepare (double sampleRate) noexcept
+    {
+        ticksPerSample = (double) juce::Time::getHighResolutionTicksPerSecond() / sampleRate;
+        resetRequested = true;
+    }
+
+    /** Any thread. The audio thread clears the statistics before its next block. */
+    void reset() noexcept     { resetRequested = true; }
+
+    /** Any thread. */
+    Stats getStats() const noexcept;
+
+    //==============================================================================
+    /** Measures one processed block, from construction to destruction. */
+    struct ScopedBlock
+    {
+       #if NEWPROJECT_DSP_LOAD_METER
+        ScopedBlock (DspLoadMeter& m, int n) noexcept
+            : meter (m), numSamples (n), start (juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedBlock() noexcept     { meter.addBlock (juce::Time::getHighResolutionTicks() - start, numSamples); }
+
+        DspLoadMeter& meter;
+        int numSamples;
+        juce::int64 start;
+       #else
+        ScopedBlock (DspLoadMeter&, int) noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    /** Measures one parameter update. */
+    struct ScopedUpdate
+    {
+       #if NEWPROJECT_DSP_LOAD_METER
+        explicit ScopedUpdate (DspLoadMeter& m) noexcept
+            : meter (m), start (juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedUpdate() noexcept    { meter.addUpdate (juce::Time::getHighResolutionTicks() - start); }
+
+        DspLoadMeter& meter;
+        juce::int64 start;
+       #else
+        explicit ScopedUpdate (DspLoadMeter&) noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedUpdate)
+    };
+
+private:
+    // 1 % per bin up to 200 % of the budget, the last bin holds everything above
+    static constexpr int numBins = 201;
+    static constexpr float binsPerUnitLoad = 100.0f;
+
+    /** Audio thread only: single writer, so no read-modify-write is needed. */
+    void addBlock (juce::int64 ticks, int numSamples) noexcept;
+    void addUpdate (juce::int64 ticks) noexcept;
+    void clearIfRequested() noexcept;
+
+    template <typename Type>
+    static void increment (std::atomic<Type>& value, Type amount = 1) noexcept
+    {
+        value.store (value.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    double ticksPerSample = 0.0;
+
+    std::array<std::atomic<juce::uint32>, numBins> bins {};
+    std::atomic<juce::int64> numBlocks { 0 }, numOverruns { 0 }, maxUpdateTicks { 0 };
+    std::atomic<float> maxLoad { 0.0f };
+    std::atomic<bool> resetRequested { true };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DspLoadMeter)
+};
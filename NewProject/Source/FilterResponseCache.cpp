@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    FilterResponseCache.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterResponseCache.h"
+#include "PluginProcessor.h"
+#include "LinearPhaseFilter.h"
+
+//==============================================================================
+std::shared_ptr<const FilterResponseCache::Curve> FilterResponseCache::getCurve (const Settings& settings)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    auto found = std::find_if (entries.begin(), entries.end(), [&] (const Entry& entry) { return entry.settings == settings; });
+
+    if (found != entries.end())
+    {
+        std::rotate (entries.begin(), found, found + 1);
+        return entries.front().curve;
+    }
+
+    auto curve = std::make_shared<Curve>();
+    compute (settings, *curve);
+
+    if ((int) entries.size() >= maxNumCurves)
+        entries.pop_back();
+
+    entries.insert (entries.begin(), { settings, curve });
+    return curve;
+}
+
+void FilterResponseCache::prepareTables (double sampleRate)
+{
+    if (sampleRate == tableSampleRate)
+        return;
+
+    tableSampleRate = sampleRate;
+    numBelowNyquist = 0;
+
+    for (int band = 0; band < SpectrumAnalyzer::numBands; ++band)
+    {
+        auto omega = juce::MathConstants<double>::twoPi * SpectrumAnalyzer::getBandFrequency (band) / sampleRate;
+
+        if (omega < juce::MathConstants<double>::pi)
+            numBelowNyquist = band + 1;
+
+        cosOmega[(size_t) band] = std::cos (omega);
+        cos2Omega[(size_t) band] = std::cos (2.0 * omega);
+    }
+}
+
+void FilterResponseCache::compute (const Settings& settings, Curve& curve)
+{
+    curve.fill ((float) minDecibels);
+
+    auto sampleRate = settings.sampleRate > 0.0 ? settings.sampleRate : 44100.0;
+    auto isLowPass = settings.passType == MultiChannelBiquad::lowPass;
+
+    if (settings.mode == NewProjectAudioProcessor::linearPhaseFilterMode)
+    {
+        computeLinearPhase (settings, sampleRate, curve);
+        return;
+    }
+
+    //the SVF is a single Butterworth section
+    MultiChannelBiquad::Coefficients sections[MultiChannelBiquad::maxNumSections];
+    auto numSections = 1;
+    auto cutoff = juce::jmin ((double) settings.cutoff, sampleRate * 0.49);
+
+    if (settings.mode == NewProjectAudioProcessor::smoothedFilterMode)
+        sections[0] = isLowPass ? MultiChannelBiquad::Coefficients::makeLowPass (sampleRate, cutoff)
+                                : MultiChannelBiquad::Coefficients::makeHighPass (sampleRate, cutoff);
+    else
+        numSections = MultiChannelBiquad::designCascade (sections,
+                                                         (MultiChannelBiquad::PassType) settings.passType,
+                                                         (MultiChannelBiquad::Response) settings.response,
+                                                         (MultiChannelBiquad::Slope) settings.slope,
+                                                         sampleRate, cutoff);
+
+    prepareTables (sampleRate);
+
+    auto n = numBelowNyquist;
+    std::fill (numerator.begin(), numerator.end(), 1.0);
+    std::fill (denominator.begin(), denominator.end(), 1.0);
+
+    //(c0 + c1 cos w + c2 cos 2w) for every band, folded into the running product
+    auto multiplyBySeries = [&] (double* product, double c0, double c1, double c2)
+    {
+        juce::FloatVectorOperations::copyWithMultiply (scratch.data(), cosOmega.data(), c1, n);
+        juce::FloatVectorOperations::addWithMultiply (scratch.data(), cos2Omega.data(), c2, n);
+        juce::FloatVectorOperations::add (scratch.data(), c0, n);
+        juce::FloatVectorOperations::multiply (product, scratch.data(), n);
+    };
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        auto& s = sections[i];
+        multiplyBySeries (numerator.data(), s.b0 * s.b0 + s.b1 * s.b1 + s.b2 * s.b2, 2.0 * (s.b0 * s.b1 + s.b1 * s.b2), 2.0 * s.b0 * s.b2);
+        multiplyBySeries (denominator.data(), 1.0 + s.a1 * s.a1 + s.a2 * s.a2, 2.0 * (s.a1 + s.a1 * s.a2), 2.0 * s.a2);
+    }
+
+    //squared magnitude, so 10 log10; rounding can push a deep notch just below zero
+    for (int band = 0; band < n; ++band)
+    {
+        auto power = numerator[(size_t) band] / denominator[(size_t) band];
+        curve[(size_t) band] = power > 0.0 ? juce::jmax (minDecibels, (float) (10.0 * std::log10 (power))) : minDecibels;
+    }
+}
+
+void FilterResponseCache::computeLinearPhase (const Settings& settings, double sampleRate, Curve& curve)
+{
+    constexpr int centre = LinearPhaseFilter::kernelLength / 2;
+
+    kernel.resize ((size_t) LinearPhaseFilter::kernelLength);
+    LinearPhaseFilter::designWindowedSinc (kernel.data(), sharedResources->getBlackmanHarrisWindow (LinearPhaseFilter::kernelLength).data(),
+                                           sampleRate, settings.passType, settings.cutoff);
+
+    prepareTables (sampleRate);
+
+    //the kernel is symmetric about its centre, so without the delay its response is
+    //h[c] + 2 sum h[c + k] cos kw, a Chebyshev series in cos w: summed with Clenshaw
+    for (int band = 0; band < numBelowNyquist; ++band)
+    {
+        auto x = cosOmega[(size_t) band];
+        auto b1 = 0.0, b2 = 0.0;
+
+        for (int k = centre; k > 0; --k)
+        {
+            auto b0 = 2.0 * kernel[(size_t) (centre + k)] + 2.0 * x * b1 - b2;
+            b2 = b1;
+            b1 = b0;
+        }
+
+        auto magnitude = std::abs (kernel[(size_t) centre] + x * b1 - b2);
+        curve[(size_t) band] = magnitude > 0.0 ? juce::jmax (minDecibels, (float) (20.0 * std::log10 (magnitude))) : minDecibels;
+    }
+}
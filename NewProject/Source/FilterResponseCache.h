@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    FilterResponseCache.h
+
+    Magnitude response of the processor's filter at the SpectrumAnalyzer
+    band frequencies, for drawing. Shared by every editor in the process
+    through juce::SharedResourcePointer, so editors showing the same
+    settings share one curve, and a curve is only computed when settings
+    nobody has asked for recently come in.
+
+    Each biquad's squared magnitude is a ratio of two cosine series,
+        |H|^2 = (n0 + n1 cos w + n2 cos 2w) / (d0 + d1 cos w + d2 cos 2w),
+    so with cos w and cos 2w tabulated once per sample rate a whole curve
+    is a few FloatVectorOperations per section and one log per point.
+
+    The linear-phase curve comes from the kernel LinearPhaseFilter designs for
+    the same settings, so it shows the real width of the transition band.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyzer.h"
+#include "SharedResources.h"
+
+//==============================================================================
+/**
+*/
+class FilterResponseCache
+{
+public:
+    FilterResponseCache() = default;
+
+    /** The parameters the curve depends on, as read from the processor. */
+    struct Settings
+    {
+        int mode = 0, passType = 0, slope = 0, response = 0;
+        float cutoff = 0.0f;
+        double sampleRate = 0.0;
+
+        bool operator== (const Settings& other) const noexcept
+        {
+            return mode == other.mode && passType == other.passType && slope == other.slope
+                    && response == other.response && cutoff == other.cutoff && sampleRate == other.sampleRate;
+        }
+
+        bool operator!= (const Settings& other) const noexcept    { return ! operator== (other); }
+    };
+
+    /** Magnitude in dB at each band frequency, floored at minDecibels. */
+    using Curve = std::array<float, SpectrumAnalyzer::numBands>;
+
+    static constexpr float minDecibels = -120.0f;
+
+    /** Message thread. The curve for settings, from the cache when possible. */
+    std::shared_ptr<const Curve> getCurve (const Settings& settings);
+
+private:
+    void compute (const Settings& settings, Curve& curve);
+    void computeLinearPhase (const Settings& settings, double sampleRate, Curve& curve);
+    void prepareTables (double sampleRate);
+
+    static constexpr int maxNumCurves = 16;
+
+    struct Entry
+    {
+        Settings settings;
+        std::shared_ptr<const Curve> curve;
+    };
+
+    std::vector<Entry> entries;   // most recently used first
+
+    // cos w and cos 2w at each band frequency below Nyquist
+    double tableSampleRate = 0.0;
+    int numBelowNyquist = 0;
+    std::array<double, SpectrumAnalyzer::numBands> cosOmega, cos2Omega, numerator, denominator, scratch;
+
+    juce::SharedResourcePointer<SharedResources> sharedResources;
+    std::vector<double> kernel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterResponseCache)
+};
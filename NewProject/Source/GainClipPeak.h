@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    GainClipPeak.h
+
+    Fused output stage: applies the gain, measures the block (peak, energy and
+    overs) and hard-clips to [-1, 1] in a single pass over each channel buffer.
+    While the gain is moving, its ramp is multiplied in beforehand and this
+    runs with a gain of 1, so the loop itself never changes per sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace GainClipPeak
+{
+    /** What the stage measured over one buffer. */
+    template <typename SampleType>
+    struct Stats
+    {
+        SampleType peak = 0;            // absolute peak after the gain, before the clip
+        SampleType sumOfSquares = 0;    // energy of the samples written out
+        int numOvers = 0;               // samples that went above 0 dBFS before the clip
+    };
+
+    template <bool hardClip, typename SampleType>
+    Stats<SampleType> processImpl (SampleType* data, int numSamples, SampleType gain) noexcept
+    {
+        using Register = juce::dsp::SIMDRegister<SampleType>;
+
+        Stats<SampleType> stats;
+
+        auto processScalar = [&] (int start, int end)
+        {
+            for (int i = start; i < end; ++i)
+            {
+                auto value = data[i] * gain;
+                auto magnitude = std::abs (value);
+
+                stats.peak = juce::jmax (stats.peak, magnitude);
+                stats.numOvers += magnitude > SampleType (1) ? 1 : 0;
+
+                if (hardClip)
+                    value = juce::jlimit (SampleType (-1), SampleType (1), value);
+
+                stats.sumOfSquares += value * value;
+                data[i] = value;
+            }
+        };
+
+        // scalar head until the data is aligned for the SIMD loads/stores
+        auto numHead = juce::jmin (numSamples, (int) (Register::getNextSIMDAlignedPtr (data) - data));
+        processScalar (0, numHead);
+
+        const auto width = (int) Register::SIMDNumElements;
+        const auto numVectorised = numHead + ((numSamples - numHead) / width) * width;
+
+        if (numVectorised > numHead)
+        {
+            const auto gains      = Register::expand (gain);
+            const auto lowerClip  = Register::expand (SampleType (-1));
+            const auto upperClip  = Register::expand (SampleType (1));
+            auto peaks = Register::expand (SampleType (0));
+            auto sums  = Register::expand (SampleType (0));
+            auto overs = Register::expand (SampleType (0));   // per-lane counts, 1.0 per over
+
+            for (int i = numHead; i < numVectorised; i += width)
+            {
+                auto value = Register::fromRawArray (data + i) * gains;
+                auto magnitude = Register::abs (value);
+
+                peaks = Register::max (peaks, magnitude);
+                overs += upperClip & Register::greaterThan (magnitude, upperClip);
+
+                if (hardClip)
+                    value = Register::min (Register::max (value, lowerClip), upperClip);
+
+                sums += value * value;
+                value.copyToRawArray (data + i);
+            }
+
+            for (size_t lane = 0; lane < Register::SIMDNumElements; ++lane)
+            {
+                stats.peak = juce::jmax (stats.peak, peaks.get (lane));
+                stats.sumOfSquares += sums.get (lane);
+                stats.numOvers += (int) overs.get (lane);
+            }
+        }
+
+        // scalar tail
+        processScalar (numVectorised, numSamples);
+
+        return stats;
+    }
+
+    //==============================================================================
+    /** Scales, measures and hard-clips a buffer of samples in one pass.
+
+        The peak and the overs are measured after the gain and before the clip, so
+        they can drive the clip indicator; the energy is measured on the output.
+    */
+    template <typename SampleType>
+    Stats<SampleType> process (SampleType* data, int numSamples, SampleType gain) noexcept
+    {
+        return processImpl<true> (data, numSamples, gain);
+    }
+
+    /** Same as process(), but leaves the clipping to a later stage. */
+    template <typename SampleType>
+    Stats<SampleType> processWithoutClip (SampleType* data, int numSamples, SampleType gain) noexcept
+    {
+        return processImpl<false> (data, numSamples, gain);
+    }
+}
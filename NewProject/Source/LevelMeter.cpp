@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LevelMeter.h"
+
+namespace
+{
+    // per timer tick, the editor ticks at 30 Hz
+    constexpr float fallDecibelsPerTick = 1.5f;
+    constexpr int holdTicks = 45;
+
+    float toDecibels (float gain)
+    {
+        return juce::jmax (LevelMeter::minDecibels, juce::Decibels::gainToDecibels (gain, LevelMeter::minDecibels));
+    }
+
+    float proportionOfHeight (float decibels)
+    {
+        return juce::jlimit (0.0f, 1.0f, 1.0f - decibels / LevelMeter::minDecibels);
+    }
+}
+
+//==============================================================================
+LevelMeter::LevelMeter()
+{
+    setOpaque (true);
+}
+
+void LevelMeter::update (const MeterFifo::Frame* frames, int numFrames)
+{
+    auto previousChannels = channels;
+    auto previousNumChannels = numChannels;
+    auto previousHasClipped = hasClipped;
+
+    float peaks[MeterFifo::maxNumChannels] = {}, rmsLevels[MeterFifo::maxNumChannels] = {};
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const auto& frame = frames[i];
+        numChannels = frame.numChannels;
+
+        for (int channel = 0; channel < frame.numChannels; ++channel)
+        {
+            peaks[channel] = juce::jmax (peaks[channel], frame.peak[channel]);
+            rmsLevels[channel] = juce::jmax (rmsLevels[channel], frame.rms[channel]);
+            hasClipped = hasClipped || frame.numOvers[channel] > 0;
+        }
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto& state = channels[(size_t) channel];
+        auto peak = toDecibels (peaks[channel]);
+
+        state.level = juce::jmax (peak, state.level - fallDecibelsPerTick);
+        state.rms = juce::jmax (toDecibels (rmsLevels[channel]), state.rms - fallDecibelsPerTick);
+
+        if (peak >= state.hold)
+        {
+            state.hold = peak;
+            state.holdTicksLeft = holdTicks;
+        }
+        else if (state.holdTicksLeft > 0)
+        {
+            --state.holdTicksLeft;
+        }
+        else
+        {
+            state.hold = juce::jmax (minDecibels, state.hold - fallDecibelsPerTick);
+        }
+    }
+
+    //a silent, settled meter draws nothing
+    auto hasChanged = numChannels != previousNumChannels || hasClipped != previousHasClipped;
+
+    for (int channel = 0; channel < numChannels && ! hasChanged; ++channel)
+    {
+        const auto& a = channels[(size_t) channel];
+        const auto& b = previousChannels[(size_t) channel];
+        hasChanged = a.level != b.level || a.rms != b.rms || a.hold != b.hold;
+    }
+
+    if (hasChanged)
+        repaint();
+}
+
+void LevelMeter::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+
+    g.fillAll (juce::Colours::black);
+
+    if (numChannels == 0)
+        return;
+
+    auto barWidth = bounds.getWidth() / (float) numChannels;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto& state = channels[(size_t) channel];
+        auto bar = bounds.withX (bounds.getX() + barWidth * (float) channel).withWidth (barWidth).reduced (barWidth > 4.0f ? 1.0f : 0.0f, 0.0f);
+
+        auto levelTop = bar.getBottom() - bar.getHeight() * proportionOfHeight (state.level);
+        g.setColour (hasClipped ? juce::Colours::red : juce::Colours::green.brighter());
+        g.fillRect (bar.withTop (levelTop));
+
+        auto rmsY = bar.getBottom() - bar.getHeight() * proportionOfHeight (state.rms);
+        g.setColour (juce::Colours::white.withAlpha (0.6f));
+        g.fillRect (bar.withTop (rmsY).withHeight (1.0f));
+
+        auto holdY = bar.getBottom() - bar.getHeight() * proportionOfHeight (state.hold);
+        g.setColour (juce::Colours::yellow);
+        g.fillRect (bar.withTop (holdY).withHeight (2.0f));
+    }
+}
+
+void LevelMeter::mouseDown (const juce::MouseEvent&)
+{
+    hasClipped = false;
+
+    for (auto& state : channels)
+    {
+        state.hold = minDecibels;
+        state.holdTicksLeft = 0;
+    }
+
+    repaint();
+}
+
+//==============================================================================
+LevelHistory::LevelHistory()
+{
+    setOpaque (true);
+    peaks.fill (LevelMeter::minDecibels);
+    rmsLevels.fill (LevelMeter::minDecibels);
+}
+
+void LevelHistory::update (const MeterFifo::Frame* frames, int numFrames)
+{
+    auto peak = 0.0f, rms = 0.0f;
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        for (int channel = 0; channel < frames[i].numChannels; ++channel)
+        {
+            peak = juce::jmax (peak, frames[i].peak[channel]);
+            rms = juce::jmax (rms, frames[i].rms[channel]);
+        }
+    }
+
+    peaks[(size_t) writeIndex] = toDecibels (peak);
+    rmsLevels[(size_t) writeIndex] = toDecibels (rms);
+    writeIndex = (writeIndex + 1) % historySize;
+
+    //stop scrolling once only silence is left on screen
+    numSilentColumns = peaks[(size_t) ((writeIndex + historySize - 1) % historySize)] > LevelMeter::minDecibels
+                           ? 0 : juce::jmin (historySize, numSilentColumns + 1);
+
+    if (numSilentColumns < historySize)
+        repaint();
+}
+
+void LevelHistory::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+
+    g.fillAll (juce::Colours::black);
+
+    auto columnWidth = bounds.getWidth() / (float) historySize;
+
+    // oldest column on the left
+    for (int i = 0; i < historySize; ++i)
+    {
+        auto index = (size_t) ((writeIndex + i) % historySize);
+        auto column = bounds.withX (bounds.getX() + columnWidth * (float) i).withWidth (columnWidth);
+
+        g.setColour (juce::Colours::green.brighter().withAlpha (0.5f));
+        g.fillRect (column.withTop (column.getBottom() - column.getHeight() * proportionOfHeight (peaks[index])));
+
+        g.setColour (juce::Colours::green.brighter());
+        g.fillRect (column.withTop (column.getBottom() - column.getHeight() * proportionOfHeight (rmsLevels[index])));
+    }
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+
+    Editor-side displays for the readings in MeterFifo. They are fed every
+    frame the processor produced since the last timer tick, so short peaks
+    always reach the screen however slowly the editor repaints.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterFifo.h"
+
+//==============================================================================
+/** Per-channel peak bars with an RMS marker, peak hold and a clip latch.
+    Click it to clear the holds and the latch.
+*/
+class LevelMeter  : public juce::Component
+{
+public:
+    LevelMeter();
+
+    static constexpr float minDecibels = -60.0f;
+
+    /** Folds the drained frames into the display. Call on every timer tick,
+        with or without frames, so the bars fall back and the holds expire.
+    */
+    void update (const MeterFifo::Frame* frames, int numFrames);
+
+    void paint (juce::Graphics&) override;
+    void mouseDown (const juce::MouseEvent&) override;
+
+private:
+    struct ChannelState
+    {
+        float level = minDecibels, rms = minDecibels, hold = minDecibels;
+        int holdTicksLeft = 0;
+    };
+
+    std::array<ChannelState, MeterFifo::maxNumChannels> channels;
+    int numChannels = 0;
+    bool hasClipped = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
+
+//==============================================================================
+/** Scrolling peak / RMS history of the loudest channel, one column per tick. */
+class LevelHistory  : public juce::Component
+{
+public:
+    LevelHistory();
+
+    void update (const MeterFifo::Frame* frames, int numFrames);
+
+    void paint (juce::Graphics&) override;
+
+private:
+    static constexpr int historySize = 256;
+
+    std::array<float, historySize> peaks, rmsLevels;
+    int writeIndex = 0, numSilentColumns = historySize;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelHistory)
+};
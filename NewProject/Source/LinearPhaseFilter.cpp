@@ -0,0 +1,292 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseFilter.h"
+#include "MultiChannelBiquad.h"
+
+//==============================================================================
+LinearPhaseFilter::LinearPhaseFilter()
+    : juce::Thread ("Linear phase filter design")
+{
+}
+
+LinearPhaseFilter::~LinearPhaseFilter()
+{
+    release();
+}
+
+void LinearPhaseFilter::prepare (double newSampleRate, int numChannels)
+{
+    release();
+
+    sampleRate = newSampleRate;
+    numChannelsPrepared = juce::jmax (0, numChannels);
+
+    kernels.assign ((size_t) (numKernelSlots * numPartitions * numBins), {});
+    designTaps.assign ((size_t) kernelLength, 0.0);
+    designBuffer.assign ((size_t) (2 * fftSize), 0.0f);
+
+    inputFrames.assign ((size_t) (numChannelsPrepared * fftSize), 0.0f);
+    outputBlocks.assign ((size_t) (numChannelsPrepared * partitionSize), 0.0f);
+    inputSpectra.assign ((size_t) (numChannelsPrepared * numPartitions * numBins), {});
+    accumulator.assign ((size_t) numBins, {});
+    fftBuffer.assign ((size_t) (2 * fftSize), 0.0f);
+    fadeBuffer.assign ((size_t) partitionSize, 0.0f);
+
+    // the first kernel is ready before any audio arrives, so offline renders
+    // never start on a stale one
+    designRequested = false;
+    designKernel (0, targetPassType.load(), targetCutoff.load());
+    activeSlot = 0;
+    pendingSlot = -1;
+
+    reset();
+    isPrepared = true;
+    startIfReady();
+}
+
+void LinearPhaseFilter::release()
+{
+    stopThread (1000);
+}
+
+void LinearPhaseFilter::setEnabled (bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == enabled)
+        return;
+
+    enabled = shouldBeEnabled;
+
+    if (shouldBeEnabled)
+        startIfReady();
+    else
+        release();
+}
+
+void LinearPhaseFilter::startIfReady()
+{
+    if (enabled && isPrepared)
+        startThread();
+}
+
+void LinearPhaseFilter::handlePendingTarget()
+{
+    if (designRequested.load() && isThreadRunning())
+        notify();
+}
+
+void LinearPhaseFilter::reset() noexcept
+{
+    std::fill (inputFrames.begin(), inputFrames.end(), 0.0f);
+    std::fill (outputBlocks.begin(), outputBlocks.end(), 0.0f);
+    std::fill (inputSpectra.begin(), inputSpectra.end(), Complex());
+    newestPartition = 0;
+    position = 0;
+}
+
+void LinearPhaseFilter::setTarget (int passType, float cutoffFrequency) noexcept
+{
+    targetPassType = passType;
+    targetCutoff = cutoffFrequency;
+    designRequested = true;
+}
+
+//==============================================================================
+void LinearPhaseFilter::run()
+{
+    while (! threadShouldExit())
+    {
+        // setTarget() can be called from the audio thread, which mustn't signal
+        // an event. So while targets keep coming in (a cutoff glide) this polls,
+        // and once one interval passes without any it sleeps until
+        // handlePendingTarget() wakes it. Only one kernel waits at a time: later
+        // requests are folded into the next design once it has been swapped in.
+        if (! designRequested.load())
+        {
+            wait (-1);
+            continue;
+        }
+
+        if (pendingSlot.load() < 0 && designRequested.exchange (false))
+        {
+            auto passType = targetPassType.load();
+            auto cutoff = targetCutoff.load();
+
+            if (passType != designedPassType || cutoff != designedCutoff)
+            {
+                auto slot = 1 - activeSlot.load();
+                designKernel (slot, passType, cutoff);
+                pendingSlot = slot;
+            }
+        }
+
+        wait (10);
+    }
+}
+
+void LinearPhaseFilter::designKernel (int slot, int passType, float cutoffFrequency)
+{
+    designedPassType = passType;
+    designedCutoff = cutoffFrequency;
+
+    designWindowedSinc (designTaps.data(), window.data(), sampleRate, passType, cutoffFrequency);
+
+    // each partition zero-padded to the FFT size, as the overlap-save needs
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        std::fill (designBuffer.begin(), designBuffer.end(), 0.0f);
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            auto n = partition * partitionSize + i;
+
+            if (n < kernelLength)
+                designBuffer[(size_t) i] = (float) designTaps[(size_t) n];
+        }
+
+        designFft.performRealOnlyForwardTransform (designBuffer.data(), true);
+
+        auto* spectrum = reinterpret_cast<const Complex*> (designBuffer.data());
+        std::copy (spectrum, spectrum + numBins, getKernel (slot, partition));
+    }
+}
+
+void LinearPhaseFilter::designWindowedSinc (double* taps, const double* window, double sampleRate,
+                                            int passType, float cutoffFrequency) noexcept
+{
+    // Blackman-Harris windowed sinc, normalised to unity gain at DC
+    constexpr int centre = kernelLength / 2;
+    auto cutoff = juce::jlimit (10.0, sampleRate * 0.49, (double) cutoffFrequency) / sampleRate;
+    auto sum = 0.0;
+
+    for (int n = 0; n < kernelLength; ++n)
+    {
+        auto x = (double) (n - centre);
+        auto sinc = n == centre ? 2.0 * cutoff
+                                : std::sin (juce::MathConstants<double>::twoPi * cutoff * x) / (juce::MathConstants<double>::pi * x);
+
+        taps[n] = sinc * window[n];
+        sum += taps[n];
+    }
+
+    for (int n = 0; n < kernelLength; ++n)
+        taps[n] /= sum;
+
+    // spectral inversion of the low-pass
+    if (passType == MultiChannelBiquad::highPass)
+    {
+        for (int n = 0; n < kernelLength; ++n)
+            taps[n] = -taps[n];
+
+        taps[centre] += 1.0;
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void LinearPhaseFilter::process (SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert (numChannels <= getNumChannels());
+    numChannels = juce::jmin (numChannels, getNumChannels());
+
+    for (int done = 0; done < numSamples;)
+    {
+        // input goes into the partition being filled, output comes out of the
+        // one computed when the previous partition filled up
+        auto numToDo = juce::jmin (numSamples - done, partitionSize - position);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + done;
+            auto* input = inputFrames.data() + channel * fftSize + partitionSize + position;
+            auto* output = outputBlocks.data() + channel * partitionSize + position;
+
+            for (int i = 0; i < numToDo; ++i)
+            {
+                input[i] = (float) data[i];
+                data[i] = (SampleType) output[i];
+            }
+        }
+
+        done += numToDo;
+        position += numToDo;
+
+        if (position == partitionSize)
+        {
+            processPartition (numChannels);
+            position = 0;
+        }
+    }
+}
+
+void LinearPhaseFilter::processPartition (int numChannels) noexcept
+{
+    auto current = activeSlot.load (std::memory_order_relaxed);
+    auto next = pendingSlot.load();
+
+    newestPartition = (newestPartition + numPartitions - 1) % numPartitions;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* frame = inputFrames.data() + channel * fftSize;
+
+        // spectrum of the last two partitions of input into the delay line
+        std::copy (frame, frame + fftSize, fftBuffer.begin());
+        std::fill (fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+        fft.performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+        auto* spectrum = reinterpret_cast<const Complex*> (fftBuffer.data());
+        std::copy (spectrum, spectrum + numBins, getInputSpectrum (channel, newestPartition));
+
+        std::copy (frame + partitionSize, frame + fftSize, frame);
+
+        auto* output = outputBlocks.data() + channel * partitionSize;
+        convolve (channel, current, output);
+
+        // a new kernel: run both for one partition and crossfade linearly
+        if (next >= 0)
+        {
+            convolve (channel, next, fadeBuffer.data());
+
+            for (int i = 0; i < partitionSize; ++i)
+                output[i] += (fadeBuffer[(size_t) i] - output[i]) * ((float) i + 0.5f) / (float) partitionSize;
+        }
+    }
+
+    if (next >= 0)
+    {
+        // the old slot is free for the design thread once pendingSlot is cleared
+        activeSlot = next;
+        pendingSlot = -1;
+    }
+}
+
+void LinearPhaseFilter::convolve (int channel, int slot, float* destination) noexcept
+{
+    std::fill (accumulator.begin(), accumulator.end(), Complex());
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto* input = getInputSpectrum (channel, (newestPartition + partition) % numPartitions);
+        const auto* kernel = getKernel (slot, partition);
+
+        for (int bin = 0; bin < numBins; ++bin)
+            accumulator[(size_t) bin] += input[bin] * kernel[bin];
+    }
+
+    auto* spectrum = reinterpret_cast<Complex*> (fftBuffer.data());
+    std::copy (accumulator.begin(), accumulator.end(), spectrum);
+    fft.performRealOnlyInverseTransform (fftBuffer.data());
+
+    // overlap-save: the first half wrapped around, the second half is the output
+    std::copy (fftBuffer.begin() + partitionSize, fftBuffer.begin() + fftSize, destination);
+}
+
+//==============================================================================
+template void LinearPhaseFilter::process<float>  (float* const*,  int, int) noexcept;
+template void LinearPhaseFilter::process<double> (double* const*, int, int) noexcept;
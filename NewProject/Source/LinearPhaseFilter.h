@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.h
+
+    Linear-phase low/high-pass: a windowed-sinc FIR of kernelLength taps run
+    with uniformly partitioned overlap-save FFT convolution. The kernel is cut
+    into numPartitions blocks of partitionSize samples, each kept as a
+    spectrum; every partitionSize input samples, the audio thread does one
+    forward FFT per channel, multiply-accumulates it against the spectra of
+    the last numPartitions inputs and does one inverse FFT.
+
+    Kernels are designed on the filter's own thread. The audio thread picks
+    a new one up at a partition boundary and crossfades to it over one
+    partition, so it never designs, allocates or waits. The thread only runs
+    while the filter is enabled, and sleeps until a new target comes in.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedResources.h"
+
+//==============================================================================
+/**
+*/
+class LinearPhaseFilter  : private juce::Thread
+{
+public:
+    LinearPhaseFilter();
+    ~LinearPhaseFilter() override;
+
+    static constexpr int partitionSize = 256;
+    static constexpr int numPartitions = 16;
+
+    // odd, so the kernel is centred on a whole sample
+    static constexpr int kernelLength = partitionSize * numPartitions - 1;
+
+    /** Stops the design thread, allocates for numChannels, designs the kernel
+        for the current target and starts the thread again if enabled. Must not
+        be called from the audio thread.
+    */
+    void prepare (double sampleRate, int numChannels);
+
+    /** Stops the design thread. */
+    void release();
+
+    /** Not on the audio thread. The design thread only runs while enabled,
+        which the processor keeps in step with the filter mode.
+    */
+    void setEnabled (bool shouldBeEnabled);
+
+    /** Not on the audio thread. Wakes the design thread if a target came in
+        while it was asleep; setTarget() can't, as it may run on the audio thread.
+    */
+    void handlePendingTarget();
+
+    /** Clears the convolution state of every channel. */
+    void reset() noexcept;
+
+    /** Any thread. Asks for a new kernel; it is designed in the background and
+        crossfaded in once it is ready. passType is a MultiChannelBiquad::PassType.
+    */
+    void setTarget (int passType, float cutoffFrequency) noexcept;
+
+    /** Any thread. Writes the kernelLength taps of the kernel designed for passType
+        and cutoffFrequency; window is the Blackman-Harris window of that length.
+    */
+    static void designWindowedSinc (double* taps, const double* window, double sampleRate,
+                                    int passType, float cutoffFrequency) noexcept;
+
+    /** One partition of buffering plus half the kernel. */
+    static constexpr int getLatencyInSamples() noexcept     { return partitionSize + kernelLength / 2; }
+
+    /** Filters numChannels buffers in place. numChannels must not be larger
+        than the value passed to prepare().
+    */
+    template <typename SampleType>
+    void process (SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    int getNumChannels() const noexcept     { return numChannelsPrepared; }
+
+private:
+    using Complex = std::complex<float>;
+
+    static constexpr int fftOrder = 9;
+    static constexpr int fftSize = 2 * partitionSize;
+    static constexpr int numBins = fftSize / 2 + 1;
+    static constexpr int numKernelSlots = 2;
+
+    static_assert ((1 << fftOrder) == fftSize, "the FFT covers two partitions");
+
+    void run() override;
+    void startIfReady();
+    void designKernel (int slot, int passType, float cutoffFrequency);
+    void processPartition (int numChannels) noexcept;
+    void convolve (int channel, int slot, float* destination) noexcept;
+
+    Complex* getKernel (int slot, int partition) noexcept
+    {
+        return kernels.data() + (slot * numPartitions + partition) * numBins;
+    }
+
+    Complex* getInputSpectrum (int channel, int partition) noexcept
+    {
+        return inputSpectra.data() + (channel * numPartitions + partition) * numBins;
+    }
+
+    double sampleRate = 44100.0;
+    int numChannelsPrepared = 0;
+    bool enabled = false, isPrepared = false;
+
+    // kernel spectra, [slot][partition][bin]. The audio thread reads activeSlot;
+    // the design thread only writes the other one, and only while nothing is pending
+    std::vector<Complex> kernels;
+    std::atomic<int> activeSlot { 0 }, pendingSlot { -1 };
+
+    std::atomic<int> targetPassType { 0 };
+    std::atomic<float> targetCutoff { 800.0f };
+    std::atomic<bool> designRequested { false };
+
+    // design thread only
+    juce::SharedResourcePointer<SharedResources> sharedResources;
+    const std::vector<double>& window { sharedResources->getBlackmanHarrisWindow (kernelLength) };
+    juce::dsp::FFT designFft { fftOrder };
+    std::vector<double> designTaps;
+    std::vector<float> designBuffer;
+    int designedPassType = -1;
+    float designedCutoff = 0.0f;
+
+    // audio thread only
+    juce::dsp::FFT fft { fftOrder };
+    std::vector<float> inputFrames;     // [channel][fftSize], last partition then the one filling up
+    std::vector<float> outputBlocks;    // [channel][partitionSize]
+    std::vector<Complex> inputSpectra;  // [channel][partition][bin], frequency-domain delay line
+    std::vector<Complex> accumulator;
+    std::vector<float> fftBuffer, fadeBuffer;
+    int newestPartition = 0, position = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseFilter)
+};
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    LookaheadLimiter.cpp
+
+  ==============================================================================
+*/
+
+#include "LookaheadLimiter.h"
+
+//==============================================================================
+void LookaheadLimiter::prepare (double newSampleRate, int numChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = juce::jmax (0, numChannels);
+
+    detectors.clear();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        detectors.add (new TruePeakDetector());
+
+    maxLookahead = juce::jmax (1, (int) std::ceil (maxLookaheadMilliseconds * 0.001 * sampleRate));
+    lookahead = juce::jlimit (1, maxLookahead, lookahead);
+
+    delayLines.assign ((size_t) (numChannels * (maxLookahead - 1 + TruePeakDetector::latencyInSamples)), 0.0);
+
+    // the hold window is one sample longer than the average, see computeGain()
+    deque.assign ((size_t) (maxLookahead + 2), Entry { 0, 1.0f });
+    averageWindow.assign ((size_t) maxLookahead, 1.0f);
+
+    reset();
+}
+
+void LookaheadLimiter::reset() noexcept
+{
+    for (auto* detector : detectors)
+        detector->reset();
+
+    delayLength = getLatencyInSamples();
+    delayPosition = 0;
+    std::fill (delayLines.begin(), delayLines.end(), 0.0);
+
+    dequeFront = 0;
+    dequeSize = 0;
+    sampleIndex = 0;
+
+    std::fill (averageWindow.begin(), averageWindow.end(), 1.0f);
+    averagePosition = 0;
+    averageSum = (double) lookahead;
+
+    envelope = 1.0f;
+}
+
+void LookaheadLimiter::setParameters (float lookaheadMilliseconds, float releaseMilliseconds) noexcept
+{
+    auto newLookahead = juce::jlimit (1, maxLookahead, juce::roundToInt (lookaheadMilliseconds * 0.001 * sampleRate));
+    auto releaseSamples = juce::jmax (1.0, releaseMilliseconds * 0.001 * sampleRate);
+
+    releaseCoefficient = (float) std::exp (-1.0 / releaseSamples);
+
+    if (newLookahead != lookahead)
+    {
+        lookahead = newLookahead;
+        reset();
+    }
+}
+
+float LookaheadLimiter::computeGain (float requiredGain) noexcept
+{
+    auto capacity = (int) deque.size();
+
+    // hold: a peak entering now keeps the minimum down for lookahead + 1 samples,
+    // which covers the true-peak estimate landing one sample either side
+    while (dequeSize > 0 && deque[(size_t) ((dequeFront + dequeSize - 1) % capacity)].gain >= requiredGain)
+        --dequeSize;
+
+    deque[(size_t) ((dequeFront + dequeSize) % capacity)] = { sampleIndex, requiredGain };
+    ++dequeSize;
+
+    while (deque[(size_t) dequeFront].index <= sampleIndex - (lookahead + 1))
+    {
+        dequeFront = (dequeFront + 1) % capacity;
+        --dequeSize;
+    }
+
+    auto heldGain = deque[(size_t) dequeFront].gain;
+    ++sampleIndex;
+
+    // attack: averaging the held gain over the lookahead ramps it down linearly
+    // and reaches the required gain exactly when the peak leaves the delay line
+    averageSum += heldGain - averageWindow[(size_t) averagePosition];
+    averageWindow[(size_t) averagePosition] = heldGain;
+
+    if (++averagePosition >= lookahead)
+    {
+        averagePosition = 0;
+
+        // resum once per window so rounding errors can't build up
+        averageSum = 0.0;
+
+        for (int i = 0; i < lookahead; ++i)
+            averageSum += averageWindow[(size_t) i];
+    }
+
+    auto targetGain = (float) (averageSum / lookahead);
+
+    // release: falls instantly, recovers along a one-pole curve
+    envelope = targetGain < envelope ? targetGain
+                                     : targetGain + releaseCoefficient * (envelope - targetGain);
+
+    return envelope;
+}
+
+template <typename SampleType>
+void LookaheadLimiter::process (SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert (numChannels <= getNumChannels());
+    numChannels = juce::jmin (numChannels, getNumChannels());
+
+    if (numChannels == 0)
+        return;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto peak = 0.0f;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            peak = juce::jmax (peak, detectors.getUnchecked (channel)->processSample ((float) channels[channel][i]));
+
+        auto gain = (double) computeGain (peak > ceiling ? ceiling / peak : 1.0f);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* line = delayLines.data() + channel * delayLength;
+            auto delayed = line[delayPosition];
+            line[delayPosition] = (double) channels[channel][i];
+
+            // the sample peak can't go over, whatever rounding the gain had
+            channels[channel][i] = (SampleType) juce::jlimit (-1.0, 1.0, delayed * gain);
+        }
+
+        if (++delayPosition >= delayLength)
+            delayPosition = 0;
+    }
+}
+
+//==============================================================================
+template void LookaheadLimiter::process<float>  (float* const*,  int, int) noexcept;
+template void LookaheadLimiter::process<double> (double* const*, int, int) noexcept;
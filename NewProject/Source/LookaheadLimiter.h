@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    LookaheadLimiter.h
+
+    Brickwall true-peak limiter, an alternative to the hard clip stage. The
+    audio is delayed by the lookahead so the gain can ramp down before a peak
+    arrives instead of clipping it:
+
+        sidechain:  4x true-peak of each channel, linked across channels
+                    -> gain needed to keep it under the ceiling
+                    -> minimum over the lookahead window (monotonic deque)
+                    -> moving average over the lookahead (smooth attack)
+                    -> one-pole release
+        audio:      delay line of lookahead + true-peak latency, times the gain
+
+    Every step costs the same per sample whatever the lookahead, and all the
+    buffers are allocated in prepare().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TruePeakDetector.h"
+
+//==============================================================================
+/**
+*/
+class LookaheadLimiter
+{
+public:
+    LookaheadLimiter() = default;
+
+    static constexpr float maxLookaheadMilliseconds = 20.0f;
+
+    /** Allocates the delay lines and sidechain buffers for the longest lookahead.
+        Must not be called from the audio thread.
+    */
+    void prepare (double sampleRate, int numChannels);
+
+    /** Clears the delay lines and the gain state. */
+    void reset() noexcept;
+
+    /** Sets the lookahead and release times. Changing the lookahead changes the
+        latency and clears the limiter.
+    */
+    void setParameters (float lookaheadMilliseconds, float releaseMilliseconds) noexcept;
+
+    /** Delay of the output relative to the input, in samples. */
+    int getLatencyInSamples() const noexcept    { return lookahead - 1 + TruePeakDetector::latencyInSamples; }
+
+    /** Limits numChannels buffers in place to a true peak of 0 dBFS. numChannels
+        must not be larger than the value passed to prepare().
+    */
+    template <typename SampleType>
+    void process (SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    int getNumChannels() const noexcept     { return detectors.size(); }
+
+private:
+    /** Adds the gain needed by the newest sample and returns the smoothed gain
+        to apply to the sample leaving the delay line.
+    */
+    float computeGain (float requiredGain) noexcept;
+
+    double sampleRate = 44100.0;
+    int lookahead = 1, maxLookahead = 1;
+    float releaseCoefficient = 0.0f;
+
+    juce::OwnedArray<TruePeakDetector> detectors;
+
+    // audio delay, [channel][delayLength], double so both precisions share it
+    std::vector<double> delayLines;
+    int delayLength = 1, delayPosition = 0;
+
+    // sliding minimum of the required gain: a ring buffer used as a deque whose
+    // values increase from front to back, so the front is the window minimum
+    struct Entry
+    {
+        juce::int64 index;
+        float gain;
+    };
+
+    std::vector<Entry> deque;
+    int dequeFront = 0, dequeSize = 0;
+    juce::int64 sampleIndex = 0;
+
+    // moving average of the held minimum
+    std::vector<float> averageWindow;
+    int averagePosition = 0;
+    double averageSum = 0.0;
+
+    float envelope = 1.0f;
+
+    static constexpr float ceiling = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LookaheadLimiter)
+};
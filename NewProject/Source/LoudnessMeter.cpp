@@ -0,0 +1,334 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+
+namespace
+{
+    /** The two K-weighting stages of BS.1770 (high shelf, then RLB high-pass),
+        designed for any sample rate rather than taken from the 48 kHz table.
+    */
+    void makeKWeighting (MultiChannelBiquad::Coefficients* sections, double sampleRate)
+    {
+        {
+            const auto f0 = 1681.974450955533, gainDb = 3.999843853973347, Q = 0.7071752369554196;
+            const auto K = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto Vh = std::pow (10.0, gainDb / 20.0);
+            const auto Vb = std::pow (Vh, 0.4996667741545416);
+            const auto a0 = 1.0 + K / Q + K * K;
+
+            auto& shelf = sections[0];
+            shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+            shelf.b1 = 2.0 * (K * K - Vh) / a0;
+            shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+            shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+            shelf.a2 = (1.0 - K / Q + K * K) / a0;
+        }
+
+        {
+            const auto f0 = 38.13547087602444, Q = 0.5003270373238773;
+            const auto K = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto a0 = 1.0 + K / Q + K * K;
+
+            auto& highPass = sections[1];
+            highPass.b0 = 1.0;
+            highPass.b1 = -2.0;
+            highPass.b2 = 1.0;
+            highPass.a1 = 2.0 * (K * K - 1.0) / a0;
+            highPass.a2 = (1.0 - K / Q + K * K) / a0;
+        }
+    }
+
+    /** BS.1770-4 channel weights: surrounds count 1.41 (+1.5 dB), LFE is ignored. */
+    float getChannelWeight (juce::AudioChannelSet::ChannelType type)
+    {
+        switch (type)
+        {
+            case juce::AudioChannelSet::LFE:
+            case juce::AudioChannelSet::LFE2:
+                return 0.0f;
+
+            case juce::AudioChannelSet::leftSurround:
+            case juce::AudioChannelSet::rightSurround:
+            case juce::AudioChannelSet::leftSurroundSide:
+            case juce::AudioChannelSet::rightSurroundSide:
+                return 1.41f;
+
+            default:
+                return 1.0f;
+        }
+    }
+
+    constexpr float minusInfinity = -std::numeric_limits<float>::infinity();
+}
+
+//==============================================================================
+LoudnessMeter::LoudnessMeter()
+    : juce::Thread ("Loudness meter")
+{
+    clearAnalysis();
+    publish();
+}
+
+LoudnessMeter::~LoudnessMeter()
+{
+    release();
+}
+
+void LoudnessMeter::prepare (double sampleRate, const juce::AudioChannelSet& channelSet, bool analyseInline)
+{
+    release();
+
+    analysesInline = analyseInline;
+
+    numChannels = juce::jmax (1, channelSet.size());
+    samplesPerStep = juce::jmax (1, juce::roundToInt (sampleRate * 0.1));
+
+    // half a second of headroom in case the meter thread gets descheduled
+    fifo.prepare (numChannels, samplesPerStep * 5);
+    analysisBuffer.setSize (numChannels, samplesPerStep);
+
+    MultiChannelBiquad::Coefficients sections[2];
+    makeKWeighting (sections, sampleRate);
+    kWeighting.prepare (numChannels, samplesPerStep);
+    kWeighting.setCoefficients (sections, 2);
+
+    truePeakDetectors.clear();
+    channelWeights.clear();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        truePeakDetectors.push_back (std::make_unique<TruePeakDetector>());
+        channelWeights.push_back (getChannelWeight (channelSet.getTypeOfChannel (channel)));
+    }
+
+    clearAnalysis();
+    numDroppedSamples = 0;
+    numSilentSamplesPushed = 0;
+    publish();
+
+    if (! analysesInline)
+        startThread();
+}
+
+void LoudnessMeter::release()
+{
+    stopThread (1000);
+}
+
+void LoudnessMeter::handlePendingAudio()
+{
+    if (fifo.getNumReady() > 0 && isThreadRunning())
+        notify();
+}
+
+LoudnessMeter::Readings LoudnessMeter::getReadings() const noexcept
+{
+    return { momentary.load(), shortTerm.load(), integrated.load(), truePeak.load(), numDroppedSamples.load() == 0 };
+}
+
+//==============================================================================
+void LoudnessMeter::run()
+{
+    while (! threadShouldExit())
+    {
+        if (resetRequested.exchange (false))
+        {
+            clearAnalysis();
+            numDroppedSamples = 0;
+        }
+
+        // the buffer holds exactly what is left of the current 100 ms step,
+        // so a step never straddles two reads
+        auto numRead = fifo.pop (analysisBuffer, samplesPerStep - samplesInStep);
+
+        if (numRead > 0)
+        {
+            analyse (numRead);
+            publish();
+        }
+        else
+        {
+            // until handlePendingAudio() or release(); the queue holds five ticks of the timer
+            wait (-1);
+        }
+    }
+}
+
+template <typename SampleType>
+void LoudnessMeter::analyseInline (const SampleType* const* channels, int numChannelsIn, int numSamples) noexcept
+{
+    if (resetRequested.exchange (false))
+        clearAnalysis();
+
+    auto stepsBefore = numStepsSeen;
+
+    // cut at the step boundaries, as the thread reads them
+    for (int done = 0; done < numSamples;)
+    {
+        auto numToDo = juce::jmin (numSamples - done, samplesPerStep - samplesInStep);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* dest = analysisBuffer.getWritePointer (channel);
+
+            if (channel < numChannelsIn)
+                for (int i = 0; i < numToDo; ++i)
+                    dest[i] = (float) channels[channel][done + i];
+            else
+                juce::FloatVectorOperations::clear (dest, numToDo);
+        }
+
+        analyse (numToDo);
+        done += numToDo;
+    }
+
+    // the readings only move once a step completes
+    if (numStepsSeen != stepsBefore)
+        publish();
+}
+
+void LoudnessMeter::analyse (int numSamples)
+{
+    auto* const* channels = analysisBuffer.getArrayOfWritePointers();
+
+    // true-peak is measured before the weighting
+    for (int channel = 0; channel < numChannels; ++channel)
+        truePeakGain = juce::jmax (truePeakGain, truePeakDetectors[(size_t) channel]->process (channels[channel], numSamples));
+
+    kWeighting.process (channels, numChannels, numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (channelWeights[(size_t) channel] == 0.0f)
+            continue;
+
+        const auto* data = channels[channel];
+        auto sum = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+            sum += (double) data[i] * (double) data[i];
+
+        stepEnergy += channelWeights[(size_t) channel] * sum;
+    }
+
+    samplesInStep += numSamples;
+
+    if (samplesInStep >= samplesPerStep)
+        finishStep();
+}
+
+void LoudnessMeter::finishStep()
+{
+    stepEnergies[(size_t) stepIndex] = stepEnergy / samplesPerStep;
+    stepIndex = (stepIndex + 1) % stepsPerShortTerm;
+    ++numStepsSeen;
+
+    stepEnergy = 0.0;
+    samplesInStep = 0;
+
+    if (numStepsSeen < stepsPerMomentary)
+        return;
+
+    // every completed step closes a new 400 ms gating block (75 % overlap)
+    auto blockEnergy = 0.0;
+
+    for (int i = 1; i <= stepsPerMomentary; ++i)
+        blockEnergy += stepEnergies[(size_t) ((stepIndex - i + stepsPerShortTerm) % stepsPerShortTerm)];
+
+    blockEnergy /= stepsPerMomentary;
+
+    auto blockLoudness = energyToLoudness (blockEnergy);
+
+    if (blockLoudness >= histogramMinimum)
+    {
+        auto bin = juce::jmin (numHistogramBins - 1, (int) ((blockLoudness - histogramMinimum) / histogramResolution));
+        histogramEnergy[(size_t) bin] += blockEnergy;
+        ++histogramCount[(size_t) bin];
+    }
+}
+
+void LoudnessMeter::clearAnalysis()
+{
+    kWeighting.reset();
+
+    for (auto& detector : truePeakDetectors)
+        detector->reset();
+
+    stepEnergies.fill (0.0);
+    histogramEnergy.fill (0.0);
+    histogramCount.fill (0);
+
+    stepEnergy = 0.0;
+    samplesInStep = 0;
+    stepIndex = 0;
+    numStepsSeen = 0;
+    truePeakGain = 0.0f;
+}
+
+void LoudnessMeter::publish()
+{
+    auto meanOfLastSteps = [this] (int numSteps)
+    {
+        auto sum = 0.0;
+
+        for (int i = 1; i <= numSteps; ++i)
+            sum += stepEnergies[(size_t) ((stepIndex - i + stepsPerShortTerm) % stepsPerShortTerm)];
+
+        return sum / numSteps;
+    };
+
+    momentary  = numStepsSeen >= stepsPerMomentary ? energyToLoudness (meanOfLastSteps (stepsPerMomentary)) : minusInfinity;
+    shortTerm  = numStepsSeen >= stepsPerShortTerm ? energyToLoudness (meanOfLastSteps (stepsPerShortTerm)) : minusInfinity;
+
+    // integrated: mean of the blocks above the absolute gate, then again over
+    // the blocks no more than 10 LU below that
+    auto energySum = 0.0;
+    juce::int64 count = 0;
+
+    for (int bin = 0; bin < numHistogramBins; ++bin)
+    {
+        energySum += histogramEnergy[(size_t) bin];
+        count += histogramCount[(size_t) bin];
+    }
+
+    auto integratedLoudness = minusInfinity;
+
+    if (count > 0)
+    {
+        auto relativeGate = energyToLoudness (energySum / (double) count) - 10.0f;
+        auto firstBin = juce::jlimit (0, numHistogramBins, (int) std::ceil ((relativeGate - histogramMinimum) / histogramResolution));
+
+        energySum = 0.0;
+        count = 0;
+
+        for (int bin = firstBin; bin < numHistogramBins; ++bin)
+        {
+            energySum += histogramEnergy[(size_t) bin];
+            count += histogramCount[(size_t) bin];
+        }
+
+        if (count > 0)
+            integratedLoudness = energyToLoudness (energySum / (double) count);
+    }
+
+    integrated = integratedLoudness;
+    truePeak = truePeakGain > 0.0f ? juce::Decibels::gainToDecibels (truePeakGain, -1000.0f) : minusInfinity;
+}
+
+//==============================================================================
+template void LoudnessMeter::analyseInline<float>  (const float* const*,  int, int) noexcept;
+template void LoudnessMeter::analyseInline<double> (const double* const*, int, int) noexcept;
+
+float LoudnessMeter::energyToLoudness (double meanEnergy) noexcept
+{
+    if (meanEnergy <= 0.0)
+        return minusInfinity;
+
+    return (float) (-0.691 + 10.0 * std::log10 (meanEnergy));
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+
+    ITU-R BS.1770-4 / EBU R128 loudness (momentary, short-term and gated
+    integrated LUFS) and 4x true-peak of the processor's output.
+
+    The audio thread only copies its output into an AudioSampleFifo; the
+    K-weighting, energy windows, gating and true-peak interpolation all run
+    on the meter's own thread, which publishes the readings through atomics.
+    The thread sleeps while the queue is empty and is woken from the message
+    thread, as the audio thread can't signal it. Samples that don't fit in
+    the queue are counted, and mark the readings as incomplete.
+
+    Offline renders can run faster than any thread keeps up with, so there
+    the analysis runs inline on the audio thread instead.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioSampleFifo.h"
+#include "MultiChannelBiquad.h"
+#include "TruePeakDetector.h"
+
+//==============================================================================
+/**
+*/
+class LoudnessMeter  : private juce::Thread
+{
+public:
+    LoudnessMeter();
+    ~LoudnessMeter() override;
+
+    /** Readings in LUFS and dBTP. Silence, or not enough audio yet, reads as
+        -infinity. isComplete is false if audio was dropped from the queue since
+        the integrated loudness was last restarted.
+    */
+    struct Readings
+    {
+        float momentary, shortTerm, integrated, truePeak;
+        bool isComplete;
+    };
+
+    /** Stops the analysis, allocates for the new format and starts again from
+        scratch. With analyseInline, push() analyses on the calling thread and
+        no thread is started. Must not be called from the audio thread.
+    */
+    void prepare (double sampleRate, const juce::AudioChannelSet& channelSet, bool analyseInline);
+
+    /** Stops the analysis thread. */
+    void release();
+
+    /** Audio thread. Copies the block into the analysis queue and returns, or
+        analyses it straight away if prepared to analyse inline.
+    */
+    template <typename SampleType>
+    void push (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        numSilentSamplesPushed = 0;
+        pushToAnalysis (channels, numChannels, numSamples);
+    }
+
+    /** Audio thread. Same as push() for a block known to be silent. Once the
+        short-term window is all silence, more of it can't change a reading,
+        so it's no longer queued and the meter thread stays asleep.
+    */
+    template <typename SampleType>
+    void pushSilence (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (numSilentSamplesPushed > (stepsPerShortTerm + 1) * samplesPerStep)
+            return;
+
+        numSilentSamplesPushed += numSamples;
+        pushToAnalysis (channels, numChannels, numSamples);
+    }
+
+    /** Message thread. Wakes the meter thread if audio is waiting in the queue. */
+    void handlePendingAudio();
+
+    /** Any thread. */
+    Readings getReadings() const noexcept;
+
+    /** Any thread. Restarts the integrated loudness and the true-peak hold. */
+    void resetIntegrated() noexcept     { resetRequested = true; }
+
+private:
+    template <typename SampleType>
+    void pushToAnalysis (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (analysesInline)
+            analyseInline (channels, numChannels, numSamples);
+        else if (auto numDropped = numSamples - fifo.push (channels, numChannels, numSamples))
+            numDroppedSamples.fetch_add (numDropped, std::memory_order_relaxed);
+    }
+
+    template <typename SampleType>
+    void analyseInline (const SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    void run() override;
+    void analyse (int numSamples);
+    void finishStep();
+    void clearAnalysis();
+    void publish();
+
+    static float energyToLoudness (double meanEnergy) noexcept;
+
+    // BS.1770 gating blocks are 400 ms long and start every 100 ms
+    static constexpr int stepsPerMomentary = 4;
+    static constexpr int stepsPerShortTerm = 30;
+
+    // integrated loudness is kept as a histogram of gating blocks, 0.1 LU per
+    // bin from the -70 LUFS absolute gate up to +30 LUFS, so memory stays fixed
+    static constexpr float histogramMinimum = -70.0f;
+    static constexpr float histogramResolution = 0.1f;
+    static constexpr int numHistogramBins = 1000;
+
+    AudioSampleFifo fifo;
+    juce::AudioBuffer<float> analysisBuffer;
+    bool analysesInline = false;
+
+    std::atomic<int> numDroppedSamples { 0 };
+    int numSilentSamplesPushed = 0;   // audio thread only
+
+    MultiChannelBiquad kWeighting;
+    std::vector<std::unique_ptr<TruePeakDetector>> truePeakDetectors;
+    std::vector<float> channelWeights;
+
+    int numChannels = 0, samplesPerStep = 0, samplesInStep = 0;
+    double stepEnergy = 0.0;
+
+    std::array<double, stepsPerShortTerm> stepEnergies;   // mean weighted energy of the last steps
+    int stepIndex = 0, numStepsSeen = 0;
+
+    std::array<double, numHistogramBins> histogramEnergy;
+    std::array<juce::int64, numHistogramBins> histogramCount;
+
+    float truePeakGain = 0.0f;
+
+    std::atomic<float> momentary, shortTerm, integrated, truePeak;
+    std::atomic<bool> resetRequested { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessMeter)
+};
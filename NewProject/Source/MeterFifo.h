@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    MeterFifo.h
+
+    Single-producer / single-consumer queue of per-block meter readings.
+    The audio thread pushes one Frame per processed block and never waits;
+    the editor drains every frame on its timer, so no peak between two
+    repaints is lost and neither side ever writes the other's data.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class MeterFifo
+{
+public:
+    MeterFifo() = default;
+
+    static constexpr int maxNumChannels = 16;
+
+    // about 0.7 s of 32-sample blocks at 44.1 kHz, far longer than a timer tick
+    static constexpr int capacity = 1024;
+
+    /** Readings of one processed block. Levels are linear gains. */
+    struct Frame
+    {
+        int numChannels = 0, numSamples = 0;
+        float peak[maxNumChannels];         // after the gain, before the clip
+        float rms[maxNumChannels];          // of the output
+        int numOvers[maxNumChannels];       // samples above 0 dBFS before the clip
+    };
+
+    /** Audio thread only. Wait-free: when the consumer has fallen behind (or no
+        editor is open) the frame is dropped and false is returned.
+    */
+    bool push (const Frame& frame) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 + size2 == 0)
+            return false;
+
+        frames[(size_t) (size1 > 0 ? start1 : start2)] = frame;
+        fifo.finishedWrite (1);
+        return true;
+    }
+
+    /** Consumer thread only. Copies up to maxFrames of the oldest frames into
+        dest and returns how many were copied.
+    */
+    int pop (Frame* dest, int maxFrames) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (maxFrames, start1, size1, start2, size2);
+
+        std::copy (frames.begin() + start1, frames.begin() + start1 + size1, dest);
+        std::copy (frames.begin() + start2, frames.begin() + start2 + size2, dest + size1);
+
+        fifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+    /** Consumer thread only. Throws away everything queued so far. */
+    void discard() noexcept
+    {
+        fifo.finishedRead (fifo.getNumReady());
+    }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<Frame, (size_t) capacity> frames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterFifo)
+};
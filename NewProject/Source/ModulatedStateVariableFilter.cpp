@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ModulatedStateVariableFilter.cpp
+
+  ==============================================================================
+*/
+
+#include "ModulatedStateVariableFilter.h"
+#include "MultiChannelBiquad.h"
+
+//==============================================================================
+void ModulatedStateVariableFilter::prepare (double newSampleRate, int numChannels, double glideSeconds)
+{
+    sampleRate = newSampleRate;
+
+    // keeps pi * fc / fs inside the range where FastMathApproximations::tan is accurate
+    maxFrequency = (float) (0.45 * sampleRate);
+
+    state.assign ((size_t) juce::jmax (0, numChannels), {});
+    cutoff.reset (sampleRate, glideSeconds);
+}
+
+void ModulatedStateVariableFilter::reset() noexcept
+{
+    std::fill (state.begin(), state.end(), ChannelState());
+    cutoff.setCurrentAndTargetValue (cutoff.getTargetValue());
+    lfoPhase = 0.0f;
+}
+
+void ModulatedStateVariableFilter::setCutoffFrequency (float newFrequency) noexcept
+{
+    cutoff.setTargetValue (juce::jlimit (10.0f, maxFrequency, newFrequency));
+}
+
+void ModulatedStateVariableFilter::setPassType (int passType) noexcept
+{
+    isHighPass = passType == MultiChannelBiquad::highPass;
+}
+
+void ModulatedStateVariableFilter::setLfo (float rateHz, float depthOctaves) noexcept
+{
+    lfoIncrement = (float) (juce::MathConstants<double>::twoPi * rateHz / sampleRate);
+    lfoDepth = depthOctaves;
+}
+
+template <typename SampleType>
+void ModulatedStateVariableFilter::process (SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert (numChannels <= getNumChannels());
+    numChannels = juce::jmin (numChannels, getNumChannels());
+
+    const auto piOverSampleRate = (float) (juce::MathConstants<double>::pi / sampleRate);
+
+    for (int start = 0; start < numSamples; start += controlInterval)
+    {
+        auto numToDo = juce::jmin (controlInterval, numSamples - start);
+
+        // control rate: smoothed cutoff, LFO, then the TPT coefficients
+        auto frequency = cutoff.skip (numToDo);
+
+        if (lfoDepth > 0.0f)
+        {
+            frequency *= std::exp2 (lfoDepth * std::sin (lfoPhase));
+
+            lfoPhase += lfoIncrement * (float) numToDo;
+
+            if (lfoPhase >= juce::MathConstants<float>::twoPi)
+                lfoPhase -= juce::MathConstants<float>::twoPi;
+        }
+
+        frequency = juce::jlimit (10.0f, maxFrequency, frequency);
+
+        auto g = (double) juce::dsp::FastMathApproximations::tan (frequency * piOverSampleRate);
+        auto a1 = 1.0 / (1.0 + g * (g + damping));
+        auto a2 = g * a1;
+        auto a3 = g * a2;
+
+        // audio rate; the high-pass output is what the band-pass and low-pass leave
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + start;
+            auto& s = state[(size_t) channel];
+
+            for (int i = 0; i < numToDo; ++i)
+            {
+                auto v0 = (double) data[i];
+                auto v3 = v0 - s.ic2eq;
+                auto v1 = a1 * s.ic1eq + a2 * v3;
+                auto v2 = s.ic2eq + a2 * s.ic1eq + a3 * v3;
+
+                s.ic1eq = 2.0 * v1 - s.ic1eq;
+                s.ic2eq = 2.0 * v2 - s.ic2eq;
+
+                data[i] = (SampleType) (isHighPass ? v0 - damping * v1 - v2 : v2);
+            }
+        }
+    }
+}
+
+//==============================================================================
+template void ModulatedStateVariableFilter::process<float>  (float* const*,  int, int) noexcept;
+template void ModulatedStateVariableFilter::process<double> (double* const*, int, int) noexcept;
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    ModulatedStateVariableFilter.h
+
+    Low- or high-pass topology-preserving-transform (trapezoidal) state variable filter
+    whose cutoff is smoothed and optionally swept by an internal LFO. Unlike a
+    biquad whose coefficients jump, the TPT structure stays stable and
+    zipper-free while the cutoff moves, so the coefficients are refreshed every
+    few samples with a cheap tan() approximation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class ModulatedStateVariableFilter
+{
+public:
+    ModulatedStateVariableFilter() = default;
+
+    /** Allocates the per-channel state. The cutoff glides to each new target over
+        glideSeconds. Must not be called from the audio thread.
+    */
+    void prepare (double sampleRate, int numChannels, double glideSeconds);
+
+    /** Clears the filter state and jumps the cutoff to its target. */
+    void reset() noexcept;
+
+    /** Sets the cutoff the filter glides to, in Hz. */
+    void setCutoffFrequency (float newFrequency) noexcept;
+
+    /** Picks the output taken from the filter; passType is a MultiChannelBiquad::PassType.
+        Both come from the same state, so switching needs no reset.
+    */
+    void setPassType (int passType) noexcept;
+
+    /** Sets the internal LFO. A depth of 0 octaves turns the modulation off. */
+    void setLfo (float rateHz, float depthOctaves) noexcept;
+
+    /** Filters numChannels buffers in place. The state is kept in double
+        precision for both sample types.
+    */
+    template <typename SampleType>
+    void process (SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    int getNumChannels() const noexcept     { return (int) state.size(); }
+
+    /** Number of samples between coefficient updates. */
+    static constexpr int controlInterval = 8;
+
+private:
+    struct ChannelState
+    {
+        double ic1eq = 0.0, ic2eq = 0.0;
+    };
+
+    double sampleRate = 44100.0;
+    float maxFrequency = 20000.0f;
+
+    std::vector<ChannelState> state;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> cutoff { 800.0f };
+
+    float lfoPhase = 0.0f, lfoIncrement = 0.0f, lfoDepth = 0.0f;
+    bool isHighPass = false;
+
+    static constexpr double damping = juce::MathConstants<double>::sqrt2; // k = 1 / Q, Butterworth
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ModulatedStateVariableFilter)
+};
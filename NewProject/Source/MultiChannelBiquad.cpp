@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    MultiChannelBiquad.cpp
+
+  ==============================================================================
+*/
+
+#include "MultiChannelBiquad.h"
+
+//==============================================================================
+MultiChannelBiquad::Coefficients MultiChannelBiquad::Coefficients::makeLowPass (double sampleRate, double frequency, double Q) noexcept
+{
+    jassert (sampleRate > 0.0);
+    jassert (frequency > 0.0 && frequency <= sampleRate * 0.5);
+    jassert (Q > 0.0);
+
+    auto w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto cosW0 = std::cos (w0);
+    auto alpha = std::sin (w0) / (2.0 * Q);
+    auto a0 = 1.0 / (1.0 + alpha);
+
+    Coefficients c;
+    c.b0 = (1.0 - cosW0) * 0.5 * a0;
+    c.b1 = (1.0 - cosW0) * a0;
+    c.b2 = c.b0;
+    c.a1 = -2.0 * cosW0 * a0;
+    c.a2 = (1.0 - alpha) * a0;
+    return c;
+}
+
+MultiChannelBiquad::Coefficients MultiChannelBiquad::Coefficients::makeHighPass (double sampleRate, double frequency, double Q) noexcept
+{
+    jassert (sampleRate > 0.0);
+    jassert (frequency > 0.0 && frequency <= sampleRate * 0.5);
+    jassert (Q > 0.0);
+
+    auto w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto cosW0 = std::cos (w0);
+    auto alpha = std::sin (w0) / (2.0 * Q);
+    auto a0 = 1.0 / (1.0 + alpha);
+
+    Coefficients c;
+    c.b0 = (1.0 + cosW0) * 0.5 * a0;
+    c.b1 = -(1.0 + cosW0) * a0;
+    c.b2 = c.b0;
+    c.a1 = -2.0 * cosW0 * a0;
+    c.a2 = (1.0 - alpha) * a0;
+    return c;
+}
+
+MultiChannelBiquad::Coefficients MultiChannelBiquad::Coefficients::makeAllPass (double sampleRate, double frequency, double Q) noexcept
+{
+    // the numerator is the denominator reversed
+    auto c = makeLowPass (sampleRate, frequency, Q);
+    c.b0 = c.a2;
+    c.b1 = c.a1;
+    c.b2 = 1.0;
+    return c;
+}
+
+int MultiChannelBiquad::designCascade (Coefficients* sectionsOut, PassType passType, Response response,
+                                       Slope slope, double sampleRate, double frequency) noexcept
+{
+    // Q of the k-th pole pair of an order-n Butterworth prototype
+    auto butterworthQ = [] (int order, int k)
+    {
+        return 1.0 / (2.0 * std::sin ((2.0 * k - 1.0) * juce::MathConstants<double>::pi / (2.0 * order)));
+    };
+
+    double qs[maxNumSections];
+    auto numSectionsUsed = juce::jlimit (1, maxNumSections, (int) slope + 1);
+    auto order = 2 * numSectionsUsed;   // 12 dB/oct per order-2 section
+
+    if (response == butterworth)
+    {
+        for (int k = 1; k <= numSectionsUsed; ++k)
+            qs[k - 1] = butterworthQ (order, k);
+    }
+    else
+    {
+        // Linkwitz-Riley of order n is a Butterworth of order n/2, squared.
+        // An odd prototype has a real pole, which squared is a biquad with Q = 0.5.
+        auto prototypeOrder = order / 2;
+        int numQs = 0;
+
+        if (prototypeOrder % 2 != 0)
+            qs[numQs++] = 0.5;
+
+        for (int k = 1; k <= prototypeOrder / 2; ++k)
+        {
+            qs[numQs++] = butterworthQ (prototypeOrder, k);
+            qs[numQs++] = butterworthQ (prototypeOrder, k);
+        }
+
+        jassert (numQs == numSectionsUsed);
+    }
+
+    for (int i = 0; i < numSectionsUsed; ++i)
+        sectionsOut[i] = passType == highPass ? Coefficients::makeHighPass (sampleRate, frequency, qs[i])
+                                              : Coefficients::makeLowPass  (sampleRate, frequency, qs[i]);
+
+    return numSectionsUsed;
+}
+
+double MultiChannelBiquad::getDecayTimeInSamples (const Coefficients* sectionsIn, int numSectionsIn,
+                                                  double attenuationDecibels) noexcept
+{
+    // an unstable or marginally stable section never decays; cap it to a minute at 48 kHz
+    constexpr double maxDecay = 48000.0 * 60.0;
+    auto logAttenuation = -std::abs (attenuationDecibels) / 20.0 * std::log (10.0);
+    double total = 0.0;
+
+    for (int i = 0; i < numSectionsIn; ++i)
+    {
+        auto& c = sectionsIn[i];
+        auto discriminant = c.a1 * c.a1 - 4.0 * c.a2;
+
+        // complex pole pair: |p| = sqrt (a2), real poles: the larger root
+        auto radius = discriminant < 0.0 ? std::sqrt (c.a2)
+                                         : (std::abs (c.a1) + std::sqrt (discriminant)) * 0.5;
+
+        if (radius >= 1.0)
+            return maxDecay;
+
+        if (radius > 0.0)
+            total += logAttenuation / std::log (radius);
+    }
+
+    return juce::jmin (total, maxDecay);
+}
+
+//==============================================================================
+void MultiChannelBiquad::prepare (int numChannels, int maxBlockSize)
+{
+    numChannelsPrepared = juce::jmax (0, numChannels);
+    numGroups = (numChannelsPrepared + laneCount - 1) / laneCount;
+    scratchCapacity = juce::jmax (1, maxBlockSize);
+
+    stateStorage.assign ((size_t) ((numGroups * maxNumSections * 2 + 1) * laneCount), 0.0);
+    scratchStorage.assign ((size_t) ((scratchCapacity + 1) * laneCount), 0.0);
+
+    state = Register::getNextSIMDAlignedPtr (stateStorage.data());
+    scratch = Register::getNextSIMDAlignedPtr (scratchStorage.data());
+}
+
+void MultiChannelBiquad::setCoefficients (const Coefficients* newSections, int numNewSections) noexcept
+{
+    numNewSections = juce::jlimit (1, maxNumSections, numNewSections);
+
+    // sections joining the cascade must not start from stale state
+    for (int group = 0; group < numGroups; ++group)
+        for (int section = numSections; section < numNewSections; ++section)
+            std::fill (getSectionState (group, section), getSectionState (group, section) + 2 * laneCount, 0.0);
+
+    std::copy (newSections, newSections + numNewSections, sections);
+    numSections = numNewSections;
+}
+
+void MultiChannelBiquad::reset() noexcept
+{
+    std::fill (stateStorage.begin(), stateStorage.end(), 0.0);
+}
+
+template <typename SampleType>
+void MultiChannelBiquad::process (SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert (numChannels <= numChannelsPrepared);
+    numChannels = juce::jmin (numChannels, numChannelsPrepared);
+
+    for (int group = 0; group * laneCount < numChannels; ++group)
+    {
+        auto firstChannel = group * laneCount;
+        processGroup (channels, firstChannel, juce::jmin (laneCount, numChannels - firstChannel), numSamples, group);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void MultiChannelBiquad::processGroup (SampleType* const* channels, int firstChannel, int numChannelsInGroup,
+                                       int numSamples, int group) noexcept
+{
+    for (int start = 0; start < numSamples; start += scratchCapacity)
+    {
+        auto numToDo = juce::jmin (scratchCapacity, numSamples - start);
+
+        // interleave: one register per sample, one lane per channel
+        for (int lane = 0; lane < laneCount; ++lane)
+        {
+            if (lane < numChannelsInGroup)
+            {
+                const auto* src = channels[firstChannel + lane] + start;
+
+                for (int i = 0; i < numToDo; ++i)
+                    scratch[i * laneCount + lane] = (double) src[i];
+            }
+            else
+            {
+                for (int i = 0; i < numToDo; ++i)
+                    scratch[i * laneCount + lane] = 0.0;
+            }
+        }
+
+        for (int section = 0; section < numSections; ++section)
+        {
+            const auto& c = sections[section];
+            const auto b0 = Register::expand (c.b0), b1 = Register::expand (c.b1), b2 = Register::expand (c.b2);
+            const auto a1 = Register::expand (c.a1), a2 = Register::expand (c.a2);
+
+            auto* sectionState = getSectionState (group, section);
+            auto z1 = Register::fromRawArray (sectionState);
+            auto z2 = Register::fromRawArray (sectionState + laneCount);
+
+            // transposed direct form II, same as juce::IIRFilter
+            for (int i = 0; i < numToDo; ++i)
+            {
+                auto* frame = scratch + i * laneCount;
+                auto in = Register::fromRawArray (frame);
+                auto out = b0 * in + z1;
+
+                z1 = b1 * in - a1 * out + z2;
+                z2 = b2 * in - a2 * out;
+
+                out.copyToRawArray (frame);
+            }
+
+            z1.copyToRawArray (sectionState);
+            z2.copyToRawArray (sectionState + laneCount);
+        }
+
+        for (int lane = 0; lane < numChannelsInGroup; ++lane)
+        {
+            auto* dest = channels[firstChannel + lane] + start;
+
+            for (int i = 0; i < numToDo; ++i)
+                dest[i] = (SampleType) scratch[i * laneCount + lane];
+        }
+    }
+}
+
+//==============================================================================
+template void MultiChannelBiquad::process<float>  (float* const*,  int, int) noexcept;
+template void MultiChannelBiquad::process<double> (double* const*, int, int) noexcept;
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    MultiChannelBiquad.h
+
+    A cascade of up to four biquads for any number of channels. The
+    per-channel state is kept as a structure-of-arrays so that channels are
+    filtered in parallel SIMD lanes, one register holding the same sample of
+    several channels, and every section of the cascade runs over the same
+    interleaved block while it is still in cache.
+
+    Coefficients and state are always double precision: low cutoffs at high
+    sample rates put the poles very close to z = 1, where float coefficients
+    are badly conditioned. Float and double buffers share the same code.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class MultiChannelBiquad
+{
+public:
+    MultiChannelBiquad() = default;
+
+    static constexpr int maxNumSections = 4;
+
+    /** Normalised coefficients (a0 == 1), same layout as juce::IIRCoefficients. */
+    struct Coefficients
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+
+        /** Second order low-pass. The default Q gives the same response as
+            IIRCoefficients::makeLowPass.
+        */
+        static Coefficients makeLowPass (double sampleRate, double frequency,
+                                         double Q = juce::MathConstants<double>::sqrt2 * 0.5) noexcept;
+
+        /** Second order high-pass. */
+        static Coefficients makeHighPass (double sampleRate, double frequency,
+                                          double Q = juce::MathConstants<double>::sqrt2 * 0.5) noexcept;
+
+        /** Second order all-pass with the poles of makeLowPass(). With the default Q
+            it is the sum of the 4th order Linkwitz-Riley low- and high-pass.
+        */
+        static Coefficients makeAllPass (double sampleRate, double frequency,
+                                         double Q = juce::MathConstants<double>::sqrt2 * 0.5) noexcept;
+    };
+
+    //choices of the "FTYPE", "FSLOPE" and "FRESP" parameters
+    enum PassType   { lowPass = 0, highPass };
+    enum Slope      { slope12dB = 0, slope24dB, slope36dB, slope48dB };
+    enum Response   { butterworth = 0, linkwitzRiley };
+
+    /** Designs a Butterworth or Linkwitz-Riley cascade into sections, which must
+        hold maxNumSections entries. Returns the number of sections used.
+    */
+    static int designCascade (Coefficients* sections, PassType passType, Response response,
+                              Slope slope, double sampleRate, double frequency) noexcept;
+
+    /** Number of samples the impulse response of the cascade takes to decay by
+        attenuationDecibels, from the radius of its slowest poles. Used as an
+        upper bound for the tail length: the decay times of the sections add up.
+    */
+    static double getDecayTimeInSamples (const Coefficients* sections, int numSections,
+                                         double attenuationDecibels) noexcept;
+
+    /** Allocates the filter state and interleaving scratch space.
+        Must not be called from the audio thread.
+    */
+    void prepare (int numChannels, int maxBlockSize);
+
+    /** Sets the sections shared by all channels. Sections that were not
+        running before start from a cleared state.
+    */
+    void setCoefficients (const Coefficients* newSections, int numNewSections) noexcept;
+
+    /** Sets a single section. */
+    void setCoefficients (const Coefficients& newCoefficients) noexcept     { setCoefficients (&newCoefficients, 1); }
+
+    /** Clears the state of every channel. */
+    void reset() noexcept;
+
+    /** Filters numChannels buffers in place. numChannels must not be larger
+        than the value passed to prepare().
+    */
+    template <typename SampleType>
+    void process (SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    int getNumChannels() const noexcept     { return numChannelsPrepared; }
+
+private:
+    using Register = juce::dsp::SIMDRegister<double>;
+    static constexpr int laneCount = (int) Register::SIMDNumElements;
+
+    template <typename SampleType>
+    void processGroup (SampleType* const* channels, int firstChannel, int numChannelsInGroup,
+                       int numSamples, int group) noexcept;
+
+    double* getSectionState (int group, int section) const noexcept
+    {
+        return state + (group * maxNumSections + section) * 2 * laneCount;
+    }
+
+    Coefficients sections[maxNumSections];
+    int numSections = 1;
+
+    int numChannelsPrepared = 0, numGroups = 0, scratchCapacity = 0;
+
+    // both arrays are over-allocated by one register so they can be SIMD-aligned
+    std::vector<double> stateStorage, scratchStorage;
+    double* state = nullptr;     // [group][section][z1 lanes..., z2 lanes...]
+    double* scratch = nullptr;   // [sample][lane]
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiChannelBiquad)
+};
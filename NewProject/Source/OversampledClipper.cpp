@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    OversampledClipper.cpp
+
+  ==============================================================================
+*/
+
+#include "OversampledClipper.h"
+
+//==============================================================================
+template <typename SampleType>
+void OversampledClipper<SampleType>::prepare (int numChannels, int maxBlockSize, int initialFactor, int initialFilterType)
+{
+    release();
+
+    numChannelsPrepared = juce::jmax (1, numChannels);
+    maxBlockSizePrepared = juce::jmax (1, maxBlockSize);
+
+    // the other modes are built when they're picked, see prepareMode()
+    factor = juce::jlimit ((int) factorOff, numFactors - 1, initialFactor);
+    filterType = juce::jlimit ((int) lowLatencyIIR, numFilterTypes - 1, initialFilterType);
+    prepareMode (factor, filterType);
+}
+
+template <typename SampleType>
+bool OversampledClipper<SampleType>::prepareMode (int factorToPrepare, int filterTypeToPrepare)
+{
+    factorToPrepare = juce::jlimit ((int) factorOff, numFactors - 1, factorToPrepare);
+    filterTypeToPrepare = juce::jlimit ((int) lowLatencyIIR, numFilterTypes - 1, filterTypeToPrepare);
+
+    if (maxBlockSizePrepared == 0 || factorToPrepare == factorOff || isReady (factorToPrepare, filterTypeToPrepare))
+        return false;
+
+    auto filter = filterTypeToPrepare == linearPhaseFIR ? Oversampler::filterHalfBandFIREquiripple
+                                                        : Oversampler::filterHalfBandPolyphaseIIR;
+
+    auto& oversampler = oversamplers[filterTypeToPrepare][factorToPrepare - 1];
+    oversampler = std::make_unique<Oversampler> ((size_t) numChannelsPrepared, (size_t) factorToPrepare, filter, true);
+    oversampler->initProcessing ((size_t) maxBlockSizePrepared);
+
+    ready[filterTypeToPrepare][factorToPrepare - 1].store (true, std::memory_order_release);
+    return true;
+}
+
+template <typename SampleType>
+void OversampledClipper<SampleType>::release()
+{
+    for (auto& row : ready)
+        for (auto& flag : row)
+            flag = false;
+
+    for (auto& row : oversamplers)
+        for (auto& oversampler : row)
+            oversampler.reset();
+
+    numChannelsPrepared = maxBlockSizePrepared = 0;
+}
+
+template <typename SampleType>
+void OversampledClipper<SampleType>::reset() noexcept
+{
+    for (int type = 0; type < numFilterTypes; ++type)
+        for (int stages = 1; stages < numFactors; ++stages)
+            if (isReady (stages, type))
+                oversamplers[type][stages - 1]->reset();
+}
+
+template <typename SampleType>
+void OversampledClipper<SampleType>::setMode (int newFactor, int newFilterType) noexcept
+{
+    newFactor = juce::jlimit ((int) factorOff, numFactors - 1, newFactor);
+    newFilterType = juce::jlimit ((int) lowLatencyIIR, numFilterTypes - 1, newFilterType);
+
+    if ((newFactor == factor && newFilterType == filterType)
+         || (newFactor != factorOff && ! isReady (newFactor, newFilterType)))
+        return;
+
+    factor = newFactor;
+    filterType = newFilterType;
+
+    if (auto* oversampler = getCurrentOversampler())
+        oversampler->reset();
+}
+
+template <typename SampleType>
+int OversampledClipper<SampleType>::getLatencyInSamples() const noexcept
+{
+    if (auto* oversampler = getCurrentOversampler())
+        return juce::roundToInt (oversampler->getLatencyInSamples());
+
+    return 0;
+}
+
+template <typename SampleType>
+void OversampledClipper<SampleType>::process (SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    auto* oversampler = getCurrentOversampler();
+
+    if (oversampler == nullptr || numSamples == 0)
+        return;
+
+    juce::dsp::AudioBlock<SampleType> block (channels, (size_t) numChannels, (size_t) numSamples);
+
+    auto oversampledBlock = oversampler->processSamplesUp (block);
+
+    for (size_t channel = 0; channel < oversampledBlock.getNumChannels(); ++channel)
+    {
+        auto* data = oversampledBlock.getChannelPointer (channel);
+        juce::FloatVectorOperations::clip (data, data, SampleType (-1), SampleType (1), (int) oversampledBlock.getNumSamples());
+    }
+
+    oversampler->processSamplesDown (block);
+}
+
+//==============================================================================
+template <typename SampleType>
+bool OversampledClipper<SampleType>::isReady (int factorToCheck, int filterTypeToCheck) const noexcept
+{
+    return ready[filterTypeToCheck][factorToCheck - 1].load (std::memory_order_acquire);
+}
+
+template <typename SampleType>
+typename OversampledClipper<SampleType>::Oversampler* OversampledClipper<SampleType>::getCurrentOversampler() const noexcept
+{
+    if (factor == factorOff)
+        return nullptr;
+
+    return oversamplers[filterType][factor - 1].get();
+}
+
+//==============================================================================
+template class OversampledClipper<float>;
+template class OversampledClipper<double>;
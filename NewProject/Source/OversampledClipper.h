@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    OversampledClipper.h
+
+    Hard clipper run at 2x, 4x or 8x the host rate to keep the harmonics it
+    creates from aliasing back into the audio band. Only this nonlinear stage
+    is oversampled; the filter and gain stay at the base rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+template <typename SampleType>
+class OversampledClipper
+{
+public:
+    OversampledClipper() = default;
+
+    //choices of the "OSFACTOR" and "OSFILTER" parameters
+    enum Factor
+    {
+        factorOff = 0,
+        factor2x,
+        factor4x,
+        factor8x,
+        numFactors
+    };
+
+    enum FilterType
+    {
+        lowLatencyIIR = 0,      // polyphase IIR half-bands, small non-linear-phase latency
+        linearPhaseFIR,         // equiripple FIR half-bands, linear phase, more latency
+        numFilterTypes
+    };
+
+    /** Builds and preallocates the oversampler of the given mode only, and
+        selects it. Must not be called from the audio thread.
+    */
+    void prepare (int numChannels, int maxBlockSize, int initialFactor, int initialFilterType);
+
+    /** Builds the oversampler of another mode, so setMode() can switch to it
+        without allocating. Returns true if it wasn't there yet. Must not be
+        called from the audio thread, and does nothing before prepare().
+    */
+    bool prepareMode (int factorToPrepare, int filterTypeToPrepare);
+
+    /** Frees the oversamplers. */
+    void release();
+
+    /** Clears the state of the oversamplers. */
+    void reset() noexcept;
+
+    /** Selects the oversampling factor and filter type. Resets the newly
+        selected oversampler when the mode changes. A mode that hasn't been
+        through prepareMode() yet is ignored and the current one kept.
+    */
+    void setMode (int newFactor, int newFilterType) noexcept;
+
+    /** Latency of the current mode, in host-rate samples. */
+    int getLatencyInSamples() const noexcept;
+
+    /** True when the clip has to go through this stage rather than being
+        fused into the gain stage.
+    */
+    bool isOversampling() const noexcept     { return getCurrentOversampler() != nullptr; }
+
+    /** Hard-clips numChannels buffers in place to [-1, 1] at the oversampled rate. */
+    void process (SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+private:
+    using Oversampler = juce::dsp::Oversampling<SampleType>;
+
+    Oversampler* getCurrentOversampler() const noexcept;
+    bool isReady (int factorToCheck, int filterTypeToCheck) const noexcept;
+
+    // [filterType][factor - 1]; the audio thread only touches the ones marked ready
+    std::unique_ptr<Oversampler> oversamplers[numFilterTypes][numFactors - 1];
+    std::atomic<bool> ready[numFilterTypes][numFactors - 1] {};
+
+    int numChannelsPrepared = 0, maxBlockSizePrepared = 0;
+    int factor = factorOff, filterType = lowLatencyIIR;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OversampledClipper)
+};
@@ -29,72 +29,206 @@ NewProjectAudioProcessorEditor::NewProjectAudioProcessorEditor (NewProjectAudioP
     lpfSlider = std::make_unique<juce::Slider>(juce::Slider::SliderStyle::RotaryVerticalDrag, juce::Slider::TextBoxBelow);
     addAndMakeVisible(lpfSlider.get());
     lpfAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "LPF", *lpfSlider);
-    lpfLabel = std::make_unique<juce::Label>("", "Low-Pass");
+    lpfLabel = std::make_unique<juce::Label>("", "Cutoff");
     addAndMakeVisible (lpfLabel.get());
     lpfLabel->attachToComponent (lpfSlider.get(), false);
     lpfLabel->setJustificationType (juce::Justification::centred);
     
+    filterModeBox = std::make_unique<juce::ComboBox>();
+    filterModeBox->addItemList (audioProcessor.apvts.getParameter ("FMODE")->getAllValueStrings(), 1);
+    addAndMakeVisible (filterModeBox.get());
+    filterModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "FMODE", *filterModeBox);
+    
+    oversamplingBox = std::make_unique<juce::ComboBox>();
+    oversamplingBox->addItemList (audioProcessor.apvts.getParameter ("OSFACTOR")->getAllValueStrings(), 1);
+    oversamplingBox->setTooltip ("Clip oversampling");
+    addAndMakeVisible (oversamplingBox.get());
+    oversamplingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "OSFACTOR", *oversamplingBox);
+    
+    filterTypeBox = std::make_unique<juce::ComboBox>();
+    filterTypeBox->addItemList (audioProcessor.apvts.getParameter ("FTYPE")->getAllValueStrings(), 1);
+    addAndMakeVisible (filterTypeBox.get());
+    filterTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "FTYPE", *filterTypeBox);
+    
+    filterSlopeBox = std::make_unique<juce::ComboBox>();
+    filterSlopeBox->addItemList (audioProcessor.apvts.getParameter ("FSLOPE")->getAllValueStrings(), 1);
+    addAndMakeVisible (filterSlopeBox.get());
+    filterSlopeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "FSLOPE", *filterSlopeBox);
+    
+    filterResponseBox = std::make_unique<juce::ComboBox>();
+    filterResponseBox->addItemList (audioProcessor.apvts.getParameter ("FRESP")->getAllValueStrings(), 1);
+    addAndMakeVisible (filterResponseBox.get());
+    filterResponseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "FRESP", *filterResponseBox);
+    
+    clipModeBox = std::make_unique<juce::ComboBox>();
+    clipModeBox->addItemList (audioProcessor.apvts.getParameter ("CLIPMODE")->getAllValueStrings(), 1);
+    addAndMakeVisible (clipModeBox.get());
+    clipModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "CLIPMODE", *clipModeBox);
+    
+    //LFO///////////////////////////////
+    
+    lfoRateSlider = std::make_unique<juce::Slider>(juce::Slider::SliderStyle::RotaryVerticalDrag, juce::Slider::TextBoxBelow);
+    addAndMakeVisible (lfoRateSlider.get());
+    lfoRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "LFORATE", *lfoRateSlider);
+    lfoRateLabel = std::make_unique<juce::Label>("", "LFO Rate");
+    addAndMakeVisible (lfoRateLabel.get());
+    lfoRateLabel->attachToComponent (lfoRateSlider.get(), false);
+    lfoRateLabel->setJustificationType (juce::Justification::centred);
+    
+    lfoDepthSlider = std::make_unique<juce::Slider>(juce::Slider::SliderStyle::RotaryVerticalDrag, juce::Slider::TextBoxBelow);
+    addAndMakeVisible (lfoDepthSlider.get());
+    lfoDepthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "LFODEPTH", *lfoDepthSlider);
+    lfoDepthLabel = std::make_unique<juce::Label>("", "LFO Depth");
+    addAndMakeVisible (lfoDepthLabel.get());
+    lfoDepthLabel->attachToComponent (lfoDepthSlider.get(), false);
+    lfoDepthLabel->setJustificationType (juce::Justification::centred);
+    
     lookAndFeelButton = std::make_unique<juce::TextButton>("LookAndFeel");
     addAndMakeVisible (lookAndFeelButton.get());
     lookAndFeelButton->addListener (this);
     
-    theLFDark.setColourScheme (juce::LookAndFeel_V4::getDarkColourScheme());
-    theLFMid.setColourScheme (juce::LookAndFeel_V4::getMidnightColourScheme());
-    theLFGrey.setColourScheme (juce::LookAndFeel_V4::getGreyColourScheme());
-    theLFLight.setColourScheme (juce::LookAndFeel_V4::getLightColourScheme());
+    //multiband///////////////////////////////
+    
+    bandsBox = std::make_unique<juce::ComboBox>();
+    bandsBox->addItemList (audioProcessor.apvts.getParameter ("BANDS")->getAllValueStrings(), 1);
+    addAndMakeVisible (bandsBox.get());
+    bandsAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "BANDS", *bandsBox);
+    
+    auto makeBandSlider = [this] (std::unique_ptr<juce::Slider>& slider, std::unique_ptr<juce::Label>& label,
+                                  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>& attachment,
+                                  const juce::String& parameterID, const juce::String& name)
+    {
+        slider = std::make_unique<juce::Slider>(juce::Slider::SliderStyle::RotaryVerticalDrag, juce::Slider::TextBoxBelow);
+        addAndMakeVisible (slider.get());
+        attachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, parameterID, *slider);
+        label = std::make_unique<juce::Label>("", name);
+        addAndMakeVisible (label.get());
+        label->attachToComponent (slider.get(), false);
+        label->setJustificationType (juce::Justification::centred);
+    };
+    
+    for (size_t i = 0; i < crossoverSliders.size(); ++i)
+        makeBandSlider (crossoverSliders[i], crossoverLabels[i], crossoverAttachments[i],
+                        "XOVER" + juce::String ((int) i + 1), "Xover " + juce::String ((int) i + 1));
+    
+    for (size_t i = 0; i < bandGainSliders.size(); ++i)
+        makeBandSlider (bandGainSliders[i], bandGainLabels[i], bandGainAttachments[i],
+                        "BGAIN" + juce::String ((int) i + 1), "Band " + juce::String ((int) i + 1));
+    
+    //meters///////////////////////////////
+    
+    levelMeter = std::make_unique<LevelMeter>();
+    addAndMakeVisible (levelMeter.get());
     
-    juce::LookAndFeel::setDefaultLookAndFeel (&theLFDark);
+    levelHistory = std::make_unique<LevelHistory>();
+    addAndMakeVisible (levelHistory.get());
     
+    loudnessLabel = std::make_unique<juce::Label>();
+    loudnessLabel->setFont (sharedResources->getMonospacedFont (12.0f));
+    loudnessLabel->setJustificationType (juce::Justification::centredRight);
+    loudnessLabel->setColour (juce::Label::backgroundColourId, juce::Colours::black);
+    loudnessLabel->setOpaque (true);
+    loudnessLabel->setTooltip ("Click to restart the integrated loudness and true-peak");
+    loudnessLabel->addMouseListener (this, false);
+    addAndMakeVisible (loudnessLabel.get());
+    
+    dspLoadLabel = std::make_unique<juce::Label>();
+    dspLoadLabel->setFont (sharedResources->getMonospacedFont (11.0f));
+    dspLoadLabel->setJustificationType (juce::Justification::centredRight);
+    dspLoadLabel->setTooltip ("DSP load: 99th percentile and worst block, as a share of the real-time budget. Click to reset");
+    dspLoadLabel->addMouseListener (this, false);
+    addAndMakeVisible (dspLoadLabel.get());
+    
+    spectrumDisplay = std::make_unique<SpectrumDisplay>();
+    addAndMakeVisible (spectrumDisplay.get());
+    
+    filterParameterValues = { audioProcessor.apvts.getRawParameterValue ("FMODE"),
+                              audioProcessor.apvts.getRawParameterValue ("LPF"),
+                              audioProcessor.apvts.getRawParameterValue ("FTYPE"),
+                              audioProcessor.apvts.getRawParameterValue ("FSLOPE"),
+                              audioProcessor.apvts.getRawParameterValue ("FRESP") };
+    updateFilterResponse();
+    
+    //the spectrum is only analysed while an editor is open to show it
+    audioProcessor.spectrumAnalyzer.setEnabled (true);
+    
+    //the editor is the only consumer of the meter queue; skip what piled up while it was closed
+    meterFrames.resize ((size_t) MeterFifo::capacity);
+    audioProcessor.meterFifo.discard();
+    
+    //set on this editor only, so other instances keep their own look
+    setLookAndFeel (&sharedResources->getLookAndFeel (currentLF));
+    
+    //the meters repaint their own area, and only when their reading moved
+    setOpaque (true);
     juce::Timer::startTimerHz (30.0);
     
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (600, 620);
 }
 
 NewProjectAudioProcessorEditor::~NewProjectAudioProcessorEditor()
 {
-    juce::LookAndFeel::setDefaultLookAndFeel (nullptr);
+    audioProcessor.spectrumAnalyzer.setEnabled (false);
+    setLookAndFeel (nullptr);
     juce::Timer::stopTimer();
 }
 
 //==============================================================================
 void NewProjectAudioProcessorEditor::paint (juce::Graphics& g)
 {
-    auto bounds = getLocalBounds();
-    auto textBounds = bounds.removeFromTop (40);
+    //background and title only change with the size, the look and feel or the display scale
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
     
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.setColour (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-    g.fillRect(bounds);
+    if (backgroundCache.isNull() || scale != backgroundCacheScale)
+        renderBackground (scale);
     
+    g.drawImage (backgroundCache, getLocalBounds().toFloat());
+}
+
+void NewProjectAudioProcessorEditor::renderBackground (float scale)
+{
+    backgroundCacheScale = scale;
     
-    //background
-    g.setColour(juce::Colours::black);
-    g.fillRect (bounds);
-    
-    //text
-    g.setColour (juce::Colours::white);
-    g.setFont (juce::Font (20.0f).italicised().withExtraKerningFactor (0.1f));
-    g.drawFittedText("DSP Lesson 1", textBounds, juce::Justification::centredLeft, 1);
-    
-    auto hasClipped = juce::Decibels::gainToDecibels (audioProcessor.meterGlobalMaxVal.load()) >= 0.0f ? true: false;
-    auto dbValue = juce::Decibels::gainToDecibels (audioProcessor.meterLocalMaxVal.load(), -100.0f);
-    dbValue = juce::jlimit (-100.0f, 0.0f, dbValue);
-    
-    auto meter = bounds.removeFromRight (40);
-    meter.reduce (10, 10);
-    
-    g.setColour (juce::Colours::black.withAlpha (0.5f));
-    g.fillRect (meter);
+    //editors of the same size, scale and look share one image
+    auto key = "background " + juce::String (getWidth()) + "x" + juce::String (getHeight())
+                 + " " + juce::String (scale) + " " + juce::String (currentLF);
     
-    meter.removeFromTop (meter.getHeight() * -dbValue / 100.0f);
-    g.setColour (hasClipped? juce::Colours::red : juce::Colours::green.brighter());
-    g.fillRect (meter);
+    backgroundCache = sharedResources->getImage (key, [this, scale]
+    {
+        juce::Image image (juce::Image::RGB,
+                           juce::jmax (1, juce::roundToInt ((float) getWidth() * scale)),
+                           juce::jmax (1, juce::roundToInt ((float) getHeight() * scale)),
+                           false);
+        
+        juce::Graphics g (image);
+        g.addTransform (juce::AffineTransform::scale (scale));
+        
+        auto bounds = getLocalBounds();
+        auto textBounds = bounds.removeFromTop (40);
+        
+        // (Our component is opaque, so we must completely fill the background with a solid colour)
+        g.setColour (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+        g.fillRect (textBounds);
+        
+        //background
+        g.setColour(juce::Colours::black);
+        g.fillRect (bounds);
+        
+        //text
+        g.setColour (juce::Colours::white);
+        g.setFont (juce::Font (20.0f).italicised().withExtraKerningFactor (0.1f));
+        g.drawFittedText("DSP Lesson 1", textBounds, juce::Justification::centredLeft, 1);
+        
+        return image;
+    });
+}
 
-//    g.setColour (juce::Colours::white);
-//    g.setFont (15.0f);
-//    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+void NewProjectAudioProcessorEditor::lookAndFeelChanged()
+{
+    backgroundCache = {};
+    repaint();
 }
 
 void NewProjectAudioProcessorEditor::resized()
@@ -102,20 +236,37 @@ void NewProjectAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
     
+    backgroundCache = {};
+    
     auto bounds = getLocalBounds();
     auto rectTop = bounds.removeFromTop (40);
-    bounds.removeFromRight (40);
-    bounds.reduce (40, 40);
+    levelMeter->setBounds (bounds.removeFromRight (40).reduced (10));
+    auto rectBottom = bounds.removeFromBottom (40).reduced (40, 8);
+    loudnessLabel->setBounds (rectBottom.removeFromRight (270));
+    levelHistory->setBounds (rectBottom.withTrimmedRight (10));
+    spectrumDisplay->setBounds (bounds.removeFromBottom (120).reduced (40, 4));
+    auto rectBands = bounds.removeFromBottom (200).reduced (40, 0);
+    bounds.removeFromTop (40);
+    bounds.reduce (40, 0);
     
     rectTop.reduce (10, 0);
     lookAndFeelButton->setBounds(rectTop.removeFromRight (120).withSizeKeepingCentre (120, 24));
+    filterModeBox->setBounds (rectTop.removeFromRight (130).withSizeKeepingCentre (120, 24));
+    oversamplingBox->setBounds (rectTop.removeFromRight (80).withSizeKeepingCentre (70, 24));
+    dspLoadLabel->setBounds (rectTop.removeFromRight (150));
     
     juce::Grid grid;
     using Track = juce::Grid::TrackInfo;
     using Fr = juce::Grid::Fr;
     
     grid.items.add (juce::GridItem (lpfSlider.get()));
+    grid.items.add (juce::GridItem (lfoRateSlider.get()));
+    grid.items.add (juce::GridItem (lfoDepthSlider.get()));
     grid.items.add (juce::GridItem (volumeSlider.get()));
+    grid.items.add (juce::GridItem (filterTypeBox.get()).withHeight (24.0f).withAlignSelf (juce::GridItem::AlignSelf::center));
+    grid.items.add (juce::GridItem (filterSlopeBox.get()).withHeight (24.0f).withAlignSelf (juce::GridItem::AlignSelf::center));
+    grid.items.add (juce::GridItem (filterResponseBox.get()).withHeight (24.0f).withAlignSelf (juce::GridItem::AlignSelf::center));
+    grid.items.add (juce::GridItem (clipModeBox.get()).withHeight (24.0f).withAlignSelf (juce::GridItem::AlignSelf::center));
     
     grid.templateColumns = { Track (Fr (1)), Track (Fr (1)), Track (Fr (1)), Track (Fr (1)), };
     grid.templateRows = { Track (Fr (1)), Track (Fr (1)) };
@@ -123,6 +274,25 @@ void NewProjectAudioProcessorEditor::resized()
     grid.rowGap = juce::Grid::Px (10);
     
     grid.performLayout (bounds);
+    
+    //multiband: the band count and the crossovers over the band gains
+    juce::Grid bandGrid;
+    
+    bandGrid.items.add (juce::GridItem (bandsBox.get()).withHeight (24.0f).withAlignSelf (juce::GridItem::AlignSelf::center));
+    
+    for (auto& slider : crossoverSliders)
+        bandGrid.items.add (juce::GridItem (slider.get()));
+    
+    for (auto& slider : bandGainSliders)
+        bandGrid.items.add (juce::GridItem (slider.get()));
+    
+    bandGrid.templateColumns = { Track (Fr (1)), Track (Fr (1)), Track (Fr (1)), Track (Fr (1)), Track (Fr (1)) };
+    bandGrid.templateRows = { Track (Fr (1)), Track (Fr (1)) };
+    bandGrid.columnGap = juce::Grid::Px (10);
+    bandGrid.rowGap = juce::Grid::Px (24);
+    
+    //room for the labels attached above the sliders
+    bandGrid.performLayout (rectBands.withTrimmedTop (20));
 }
 
 void NewProjectAudioProcessorEditor::buttonClicked(juce::Button* button)
@@ -140,45 +310,70 @@ void NewProjectAudioProcessorEditor::buttonClicked(juce::Button* button)
             m.addItem (5, "JUCE 4 look and feel", true, currentLF == 5);
             m.addItem (6, "JUCE 3 look and feel", true, currentLF == 6);
             
+            m.setLookAndFeel (&getLookAndFeel());
             auto result = m.showAt(lookAndFeelButton.get());
             
-            if (result == 1)
-                juce::LookAndFeel::setDefaultLookAndFeel (&theLFDark);
-            
-            else if (result == 2)
-                juce::LookAndFeel::setDefaultLookAndFeel (&theLFMid);
-            
-            else if (result == 3)
-                juce::LookAndFeel::setDefaultLookAndFeel (&theLFGrey);
-            
-            else if (result == 4)
-                juce::LookAndFeel::setDefaultLookAndFeel(&theLFLight);
-            
-            else if (result == 5)
-                juce::LookAndFeel::setDefaultLookAndFeel (&theLFV3);
-            
-            else if (result == 6)
-                juce::LookAndFeel::setDefaultLookAndFeel (&theLFV2);
-            
+            //the menu ids are the SharedResources styles
             if (result != 0)
+            {
                 currentLF = result;
+                setLookAndFeel (&sharedResources->getLookAndFeel (currentLF));
+            }
         }
 }
 
 void NewProjectAudioProcessorEditor::timerCallback()
 {
-    repaint();
+    auto numFrames = audioProcessor.meterFifo.pop (meterFrames.data(), (int) meterFrames.size());
+    
+    levelMeter->update (meterFrames.data(), numFrames);
+    levelHistory->update (meterFrames.data(), numFrames);
+    
+    if (audioProcessor.spectrumAnalyzer.getNextFrame (spectrumFrame))
+        spectrumDisplay->setFrame (spectrumFrame);
+    
+    updateFilterResponse();
+    
+    auto format = [] (float value) { return value > -70.0f ? juce::String (value, 1) : juce::String ("-inf"); };
+    auto readings = audioProcessor.loudnessMeter.getReadings();
+    
+    loudnessLabel->setText ("M " + format (readings.momentary)
+                             + "  S " + format (readings.shortTerm)
+                             + "  I " + format (readings.integrated) + " LUFS"
+                             + "  TP " + format (readings.truePeak) + " dBTP"
+                             + (readings.isComplete ? juce::String() : juce::String (" (dropouts)")),
+                            juce::dontSendNotification);
+    
+    auto load = audioProcessor.getDspLoad();
+    auto percent = [] (float value) { return juce::String (juce::roundToInt (value * 100.0f)) + "%"; };
+    
+    dspLoadLabel->setText ("DSP " + percent (load.p99) + " max " + percent (load.max)
+                            + (load.numOverruns > 0 ? " x" + juce::String (load.numOverruns) : juce::String()),
+                           juce::dontSendNotification);
 }
 
-void NewProjectAudioProcessorEditor::mouseDown(const juce::MouseEvent& e)
+void NewProjectAudioProcessorEditor::mouseDown (const juce::MouseEvent& e)
 {
-    auto bounds = getLocalBounds();
-    bounds.removeFromTop (40);
-    auto meter = bounds.removeFromRight (40);
+    if (e.eventComponent == loudnessLabel.get())
+        audioProcessor.loudnessMeter.resetIntegrated();
+    else if (e.eventComponent == dspLoadLabel.get())
+        audioProcessor.resetDspLoad();
+}
+
+void NewProjectAudioProcessorEditor::updateFilterResponse()
+{
+    FilterResponseCache::Settings settings;
+    settings.mode = (int) filterParameterValues[0]->load();
+    settings.cutoff = filterParameterValues[1]->load();
+    settings.passType = (int) filterParameterValues[2]->load();
+    settings.slope = (int) filterParameterValues[3]->load();
+    settings.response = (int) filterParameterValues[4]->load();
+    settings.sampleRate = audioProcessor.getSampleRate();
     
-    if (meter.contains(e.getMouseDownPosition()))
-    {
-        audioProcessor.meterGlobalMaxVal.store (0.0f);
-    }
+    //compared every tick, recomputed (or fetched) only on a change
+    if (settings == shownFilterSettings)
+        return;
     
+    shownFilterSettings = settings;
+    spectrumDisplay->setFilterResponse (filterResponses->getCurve (settings)->data());
 }
@@ -10,6 +10,10 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "LevelMeter.h"
+#include "SharedResources.h"
+#include "SpectrumDisplay.h"
+#include "FilterResponseCache.h"
 
 //==============================================================================
 /**
@@ -26,21 +30,54 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
     void mouseDown (const juce::MouseEvent& e) override;
+    void lookAndFeelChanged() override;
     
     void buttonClicked (juce::Button* button) override;
     void timerCallback() override;
 
 private:
     
-    std::unique_ptr<juce::Slider> volumeSlider, lpfSlider;
-    std::unique_ptr<juce::Label> volumeLabel, lpfLabel;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> volumeAttachment, lpfAttachment;
+    //look-and-feels, fonts and the background, shared by every editor in the process
+    juce::SharedResourcePointer<SharedResources> sharedResources;
+    
+    std::unique_ptr<juce::Slider> volumeSlider, lpfSlider, lfoRateSlider, lfoDepthSlider;
+    std::unique_ptr<juce::Label> volumeLabel, lpfLabel, lfoRateLabel, lfoDepthLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> volumeAttachment, lpfAttachment, lfoRateAttachment, lfoDepthAttachment;
+    std::unique_ptr<juce::ComboBox> filterModeBox, oversamplingBox, filterTypeBox, filterSlopeBox, filterResponseBox, clipModeBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> filterModeAttachment, oversamplingAttachment, clipModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> filterTypeAttachment, filterSlopeAttachment, filterResponseAttachment;
     std::unique_ptr<juce::TextButton> lookAndFeelButton;
     
-    juce::LookAndFeel_V4 theLFDark, theLFMid, theLFGrey, theLFLight;
-    juce::LookAndFeel_V3 theLFV3;
-    juce::LookAndFeel_V2 theLFV2;
-    int currentLF = 1;
+    //multiband: the band count, a crossover per split and a gain per band
+    std::unique_ptr<juce::ComboBox> bandsBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> bandsAttachment;
+    std::array<std::unique_ptr<juce::Slider>, NewProjectAudioProcessor::maxNumBands - 1> crossoverSliders;
+    std::array<std::unique_ptr<juce::Slider>, NewProjectAudioProcessor::maxNumBands> bandGainSliders;
+    std::array<std::unique_ptr<juce::Label>, NewProjectAudioProcessor::maxNumBands - 1> crossoverLabels;
+    std::array<std::unique_ptr<juce::Label>, NewProjectAudioProcessor::maxNumBands> bandGainLabels;
+    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, NewProjectAudioProcessor::maxNumBands - 1> crossoverAttachments;
+    std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, NewProjectAudioProcessor::maxNumBands> bandGainAttachments;
+    std::unique_ptr<LevelMeter> levelMeter;
+    std::unique_ptr<LevelHistory> levelHistory;
+    std::unique_ptr<juce::Label> loudnessLabel, dspLoadLabel;
+    std::unique_ptr<SpectrumDisplay> spectrumDisplay;
+    SpectrumAnalyzer::Frame spectrumFrame;
+    
+    //the response overlay only changes when one of these moves, and editors share the curves
+    juce::SharedResourcePointer<FilterResponseCache> filterResponses;
+    std::array<std::atomic<float>*, 5> filterParameterValues;
+    FilterResponseCache::Settings shownFilterSettings;
+    void updateFilterResponse();
+    
+    //static layers, redrawn only on resize, look and feel or scale changes
+    juce::Image backgroundCache;
+    float backgroundCacheScale = 1.0f;
+    void renderBackground (float scale);
+    
+    //every frame queued since the last tick, drained in one go
+    std::vector<MeterFifo::Frame> meterFrames;
+    
+    int currentLF = SharedResources::darkStyle;
     
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -8,6 +8,33 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "GainClipPeak.h"
+#include "StateFormat.h"
+
+namespace
+{
+    //multiband parameters, one per split and one per band
+    const char* const crossoverIDs[] = { "XOVER1", "XOVER2", "XOVER3", "XOVER4" };
+    const char* const bandGainIDs[] = { "BGAIN1", "BGAIN2", "BGAIN3", "BGAIN4", "BGAIN5" };
+    
+    static_assert (juce::numElementsInArray (crossoverIDs) == NewProjectAudioProcessor::maxNumBands - 1, "one crossover per split");
+    static_assert (juce::numElementsInArray (bandGainIDs) == NewProjectAudioProcessor::maxNumBands, "one gain per band");
+    
+    /** True if no sample of the channels is further from zero than threshold. */
+    template <typename SampleType>
+    bool isSilent (const SampleType* const* channels, int numChannels, int numSamples, SampleType threshold) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax (channels[channel], numSamples);
+            
+            if (range.getStart() < -threshold || range.getEnd() > threshold)
+                return false;
+        }
+        
+        return true;
+    }
+}
 
 //==============================================================================
 NewProjectAudioProcessor::NewProjectAudioProcessor()
@@ -22,12 +49,71 @@ NewProjectAudioProcessor::NewProjectAudioProcessor()
                        ), apvts (*this, nullptr, "Parameters", createParameters())
 #endif
 {
-    apvts.state.addListener (this);
+    //the DSP reads its own copy of every parameter, so a program can be switched
+    //on the audio thread without going through the host first
+    auto& parameters = getParameters();
+    dspParameterValues.reset (new std::atomic<float>[(size_t) parameters.size()]);
+    
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameters.getUnchecked (i));
+        dspParameterValues[(size_t) i] = ranged != nullptr ? ranged->convertFrom0to1 (ranged->getValue()) : 0.0f;
+        parameterNeedsFade.push_back (ranged != nullptr && (ranged->isDiscrete() || ranged->paramID == "LIMLOOK"));
+    }
+    
+    auto getDspValue = [this] (const juce::String& parameterID)
+    {
+        return &dspParameterValues[(size_t) apvts.getParameter (parameterID)->getParameterIndex()];
+    };
+    
+    lpfValue = getDspValue ("LPF");
+    volumeValue = getDspValue ("VOL");
+    filterModeValue = getDspValue ("FMODE");
+    filterTypeValue = getDspValue ("FTYPE");
+    filterSlopeValue = getDspValue ("FSLOPE");
+    filterResponseValue = getDspValue ("FRESP");
+    lfoRateValue = getDspValue ("LFORATE");
+    lfoDepthValue = getDspValue ("LFODEPTH");
+    oversamplingFactorValue = getDspValue ("OSFACTOR");
+    oversamplingFilterValue = getDspValue ("OSFILTER");
+    clipModeValue = getDspValue ("CLIPMODE");
+    limiterLookaheadValue = getDspValue ("LIMLOOK");
+    limiterReleaseValue = getDspValue ("LIMREL");
+    numBandsValue = getDspValue ("BANDS");
+    
+    for (size_t i = 0; i < crossoverValues.size(); ++i)
+        crossoverValues[i] = getDspValue (crossoverIDs[i]);
+    
+    for (size_t i = 0; i < bandGainValues.size(); ++i)
+        bandGainValues[i] = getDspValue (bandGainIDs[i]);
+    
+    for (auto* parameter : getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+            apvts.addParameterListener (withID->paramID, this);
+    
+    //factory programs, plus the bank installed with the plugin if there is one
+    presetBank.initialise (getParameters());
+    
+    auto factoryBank = juce::File::getSpecialLocation (juce::File::commonApplicationDataDirectory)
+                           .getChildFile (JucePlugin_Manufacturer)
+                           .getChildFile (JucePlugin_Name)
+                           .getChildFile ("Factory.npbank");
+    
+    if (factoryBank.existsAsFile())
+        presetBank.loadBank (factoryBank);
+    
     init();
+    
+    startTimerHz (10);
 }
 
 NewProjectAudioProcessor::~NewProjectAudioProcessor()
 {
+    stopTimer();
+    
+    for (auto* parameter : getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+            apvts.removeParameterListener (withID->paramID, this);
 }
 
 //==============================================================================
@@ -65,31 +151,103 @@ bool NewProjectAudioProcessor::isMidiEffect() const
 
 double NewProjectAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    //filter ring-out down to -120 dB plus the oversampling filters, for the current settings
+    return tailLengthSeconds.load();
 }
 
 int NewProjectAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return presetBank.size();   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                                // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int NewProjectAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram.load();
 }
 
 void NewProjectAudioProcessor::setCurrentProgram (int index)
 {
+    //lock-free and constant time, from whichever thread the host calls it on; the
+    //audio thread applies it at its next sub-block and the host hears about it after
+    if (! juce::isPositiveAndBelow (index, presetBank.size()))
+        return;
+    
+    currentProgram = index;
+    programToApply = index;
+    
+    if (! isActive && juce::MessageManager::existsAndIsCurrentThread())
+        publishProgram();
 }
 
 const juce::String NewProjectAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return juce::isPositiveAndBelow (index, presetBank.size()) ? presetBank[index].name : juce::String();
 }
 
 void NewProjectAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    presetBank.setName (index, newName);
+}
+
+bool NewProjectAudioProcessor::loadPresetBank (const juce::File& file)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    
+    if (! presetBank.loadBank (file))
+        return false;
+    
+    updateHostDisplay();
+    return true;
+}
+
+bool NewProjectAudioProcessor::programNeedsFade (int index) const noexcept
+{
+    //modes and the lookahead reset DSP state, so switching them needs the fade;
+    //continuous values glide on their smoothers
+    auto& values = presetBank[index].plainValues;
+    
+    for (size_t i = 0; i < values.size(); ++i)
+        if (parameterNeedsFade[i] && values[i] != dspParameterValues[i].load (std::memory_order_relaxed))
+            return true;
+    
+    return false;
+}
+
+void NewProjectAudioProcessor::stageProgram (int index) noexcept
+{
+    auto& values = presetBank[index].plainValues;
+    
+    for (size_t i = 0; i < values.size(); ++i)
+        dspParameterValues[i].store (values[i], std::memory_order_relaxed);
+    
+    //every stage picks its new values up in applyPendingUpdates()
+    mustUpdateFilter = true;
+    mustUpdateVolume = true;
+    mustUpdateClipper = true;
+    mustUpdateBands = true;
+    
+    programToPublish = index;
+}
+
+void NewProjectAudioProcessor::publishProgram()
+{
+    //with nothing processing, nobody else is going to apply it
+    if (! isActive && programToApply.load() >= 0)
+        programToPublish = programToApply.exchange (-1);
+    
+    auto index = programToPublish.exchange (-1);
+    
+    if (index < 0)
+        return;
+    
+    //the DSP already runs on these; this only brings the host and the editor in line
+    auto& values = presetBank[index].values;
+    auto& parameters = getParameters();
+    
+    for (int i = 0; i < parameters.size(); ++i)
+        if (values[(size_t) i] != parameters.getUnchecked (i)->getValue())
+            parameters.getUnchecked (i)->setValueNotifyingHost (values[(size_t) i]);
 }
 
 //==============================================================================
@@ -110,6 +268,13 @@ void NewProjectAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    
+    isActive = false;
+    loudnessMeter.release();
+    spectrumAnalyzer.release();
+    linearPhaseFilter.release();
+    std::get<0> (oversampledClippers).release();
+    std::get<1> (oversampledClippers).release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -120,9 +285,11 @@ bool NewProjectAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout works (mono, stereo, 5.1, 7.1.4, ambisonics...) as long as
+    // it has no more than maxNumChannels channels.
+    auto mainOutput = layouts.getMainOutputChannelSet();
+    
+    if (mainOutput.isDisabled() || mainOutput.size() > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -137,6 +304,25 @@ bool NewProjectAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
 #endif
 
 void NewProjectAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processSamples (buffer);
+}
+
+void NewProjectAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processSamples (buffer);
+}
+
+bool NewProjectAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+//==============================================================================
+template <typename SampleType>
+void NewProjectAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
 {
     
     if (!isActive)
@@ -144,20 +330,14 @@ void NewProjectAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
         return;
     }
     
-    if (mustUpdateProcessing)
-    {
-        update();
-    }
+    auto numSamples = buffer.getNumSamples();
+    const DspLoadMeter::ScopedBlock loadMeasurement (dspLoad, numSamples);
     
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
-    
-    auto numSamples = buffer.getNumSamples();
+
     auto numChannels = juce::jmin (totalNumInputChannels, totalNumOutputChannels);
-    
-    auto sumMaxVal = 0.0f;
-    auto currentMaxVal = meterGlobalMaxVal.load();
 
     // In case we have more outputs than inputs, this code clears any output
     // channels that didn't contain input data, (because these aren't
@@ -168,59 +348,441 @@ void NewProjectAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, numSamples);
     
+    numChannels = juce::jmin (numChannels, iirFilter.getNumChannels());
     
-
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    // Render in internal sub-blocks so parameter changes are picked up every
+    // subBlockSize samples, whatever buffer size the host uses.
+    auto subBlockSize = automationGranularity.load();
+    
+    //the ramp buffers are sized for the prepared block size
+    if (subBlockSize <= 0 || subBlockSize > maxSubBlockSize)
+        subBlockSize = juce::jmax (1, juce::jmin (numSamples, maxSubBlockSize));
+    
+    auto* const* channels = buffer.getArrayOfWritePointers();
+    SampleType* subBlockChannels[maxNumChannels];
+    
+    MeterFifo::Frame meters;
+    meters.numChannels = numChannels;
+    meters.numSamples = numSamples;
+    double sumsOfSquares[maxNumChannels] = {};
+    
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        auto* channelData = buffer.getWritePointer (channel);
-        auto channelMaxVal = 0.0f;
+        meters.peak[channel] = 0.0f;
+        meters.rms[channel] = 0.0f;
+        meters.numOvers[channel] = 0;
+    }
+    
+    auto inputIsSilent = isSilent (channels, numChannels, numSamples, (SampleType) silenceThreshold);
+    
+    if (isAnalysingOutput)
+        spectrumAnalyzer.pushInput (channels, numChannels, numSamples);
+    
+    //nothing in and nothing left ringing: skip the chain and output exact zeros
+    if (isIdle && inputIsSilent)
+    {
+        //already silent, so a program switch needs no fade
+        if (programFade == fadingOut)
+            stageProgram (pendingProgram);
         
-        iirFilter[channel].processSamples(channelData, numSamples);
+        if (programToApply.load (std::memory_order_relaxed) >= 0)
+            stageProgram (programToApply.exchange (-1));
         
-        outputVolume[channel].applyGain (channelData, numSamples);
+        programFade = notFading;
+        std::get<BlockSmoother<SampleType>> (programFaders).setCurrentAndTargetValue (1);
         
-        //absolute value of all samples in a buffer
-        //is the current sample larger than the current max?
-            //if yes --  channelMaxVal = new max
+        applyPendingUpdates();
+        advanceControlSmoothers (numSamples);
+        std::get<BlockSmoother<SampleType>> (gainSmoothers).skip (numSamples);
         
+        for (auto& smoother : std::get<std::array<BlockSmoother<SampleType>, maxNumBands>> (bandGainSmoothers))
+            smoother.skip (numSamples);
         
-        //find max val in this channel / buffer of samples
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::clear (channels[channel], numSamples);
         
+        meterFifo.push (meters);
         
+        if (isAnalysingOutput)
+        {
+            loudnessMeter.pushSilence (channels, numChannels, numSamples);
+            spectrumAnalyzer.pushOutput (channels, numChannels, numSamples);
+        }
         
-        for (int sample = 0; sample < numSamples ; ++sample)
+        return;
+    }
+    
+    //the chain was cleared when it went idle, so it picks up from silence
+    isIdle = false;
+    
+    for (int start = 0; start < numSamples; start += subBlockSize)
+    {
+        auto subBlockLength = juce::jmin (subBlockSize, numSamples - start);
+        auto& programFader = std::get<BlockSmoother<SampleType>> (programFaders);
+        
+        //a new program: staged now if it only moves continuous values, or once the
+        //fade-out is silent; a later one replaces a program still waiting for that
+        if (programToApply.load (std::memory_order_relaxed) >= 0)
         {
-            auto rectifiedVal = std::abs (channelData[sample]);
-            
-            if (channelMaxVal < rectifiedVal)
-                channelMaxVal = rectifiedVal;
+            auto index = programToApply.exchange (-1);
             
-            if (currentMaxVal < rectifiedVal)
-                currentMaxVal = rectifiedVal;
+            if (programFade == fadingOut || programNeedsFade (index))
+            {
+                pendingProgram = index;
+                programFader.setTargetValue (0);
+                programFade = fadingOut;
+            }
+            else
+            {
+                stageProgram (index);
+            }
         }
         
-        sumMaxVal += channelMaxVal; //sum of ch 0 and ch 1 max vals
+        if (programFade != fadingOut)
+        {
+            applyPendingUpdates();
+        }
+        else if (! programFader.isSmoothing())
+        {
+            //silent: switch from a clean state and fade in
+            stageProgram (pendingProgram);
+            applyPendingUpdates();
+            reset();
+            programFader.setTargetValue (1);
+            programFade = fadingIn;
+        }
+        
+        advanceControlSmoothers (subBlockLength);
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            subBlockChannels[channel] = channels[channel] + start;
         
-        meterGlobalMaxVal.store (currentMaxVal);
+        processSubBlock (subBlockChannels, numChannels, subBlockLength, meters, sumsOfSquares);
         
-        for (int sample = 0; sample < buffer.getNumSamples(); ++ sample)
+        if (programFade != notFading)
+            applyProgramFade (subBlockChannels, numChannels, subBlockLength);
+    }
+    
+    //publish the meters once per block, dropped if the editor isn't keeping up
+    for (int channel = 0; channel < numChannels; ++channel)
+        meters.rms[channel] = numSamples > 0 ? (float) std::sqrt (sumsOfSquares[channel] / numSamples) : 0.0f;
+    
+    meterFifo.push (meters);
+    
+    if (isAnalysingOutput)
+    {
+        loudnessMeter.push (channels, numChannels, numSamples);
+        spectrumAnalyzer.pushOutput (channels, numChannels, numSamples);
+    }
+    
+    //judged on the input, whatever the gain: once it has been silent for the filter
+    //and crossover ring-out plus the latency twice over (the oversampling filters in
+    //and out, the lookahead), everything still held in the chain is silent too
+    numSilentSamples = inputIsSilent ? numSilentSamples + numSamples : 0;
+    
+    auto samplesUntilIdle = filterTailInSamples + crossoverTailInSamples + 2.0 * pendingLatency.load (std::memory_order_relaxed);
+    
+    if (numSilentSamples > samplesUntilIdle)
+    {
+        clearState();
+        isIdle = true;
+    }
+}
+
+void NewProjectAudioProcessor::clearState() noexcept
+{
+    //only what rings or delays, nothing is redesigned; the limiter keeps its gain
+    //and releases from there once audio comes back
+    iirFilter.reset();
+    svfFilter.reset();
+    linearPhaseFilter.reset();
+    
+    for (auto& filter : crossoverLowPasses)     filter.reset();
+    for (auto& filter : crossoverHighPasses)    filter.reset();
+    for (auto& filter : crossoverAllPasses)     filter.reset();
+    crossoverSum.reset();
+    
+    if (isUsingDoublePrecision())
+        std::get<OversampledClipper<double>> (oversampledClippers).reset();
+    else
+        std::get<OversampledClipper<float>> (oversampledClippers).reset();
+}
+
+void NewProjectAudioProcessor::applyPendingUpdates()
+{
+    //only recompute the stages whose parameters moved
+    if (mustUpdateFilter.load (std::memory_order_relaxed) && mustUpdateFilter.exchange (false))
+    {
+        const DspLoadMeter::ScopedUpdate updateMeasurement (dspLoad);
+        updateFilter();
+    }
+    
+    if (mustUpdateVolume.load (std::memory_order_relaxed) && mustUpdateVolume.exchange (false))
+    {
+        const DspLoadMeter::ScopedUpdate updateMeasurement (dspLoad);
+        updateVolume();
+    }
+    
+    if (mustUpdateClipper.load (std::memory_order_relaxed) && mustUpdateClipper.exchange (false))
+    {
+        const DspLoadMeter::ScopedUpdate updateMeasurement (dspLoad);
+        updateClipper();
+    }
+    
+    if (mustUpdateBands.load (std::memory_order_relaxed) && mustUpdateBands.exchange (false))
+    {
+        const DspLoadMeter::ScopedUpdate updateMeasurement (dspLoad);
+        updateBands();
+    }
+}
+
+template <typename SampleType>
+void NewProjectAudioProcessor::applyProgramFade (SampleType* const* channels, int numChannels, int numSamples)
+{
+    auto& programFader = std::get<BlockSmoother<SampleType>> (programFaders);
+    
+    if (auto* ramp = programFader.getNextBlock (numSamples))
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::multiply (channels[channel], ramp, numSamples);
+    }
+    else if (programFade == fadingOut)
+    {
+        //the last sub-block of the fade-out, silent; the program is staged on the next one
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::clear (channels[channel], numSamples);
+    }
+    else
+    {
+        programFade = notFading;
+    }
+}
+
+void NewProjectAudioProcessor::advanceControlSmoothers (int numSamples)
+{
+    //nothing to do once every glide has arrived
+    if (cutoffSmoother.isSmoothing() || lfoRateSmoother.isSmoothing() || lfoDepthSmoother.isSmoothing())
+    {
+        const DspLoadMeter::ScopedUpdate updateMeasurement (dspLoad);
+        
+        cutoffSmoother.skip (numSamples);
+        lfoRateSmoother.skip (numSamples);
+        lfoDepthSmoother.skip (numSamples);
+        
+        //the tail estimate takes a log per pole, so it waits for the glide to arrive
+        designFilter (! (cutoffSmoother.isSmoothing() || lfoRateSmoother.isSmoothing() || lfoDepthSmoother.isSmoothing()));
+    }
+    
+    if (releaseSmoother.isSmoothing())
+        limiter.setParameters (limiterLookaheadValue->load(), releaseSmoother.skip (numSamples));
+    
+    auto crossoversMoved = false, crossoversStillGliding = false;
+    
+    for (auto& smoother : crossoverSmoothers)
+    {
+        if (smoother.isSmoothing())
         {
-            
-            
-            //Hard clip values
-            channelData[sample] = juce::jlimit (-1.0f, 1.0f, channelData[sample]);
+            smoother.skip (numSamples);
+            crossoversMoved = true;
+            crossoversStillGliding = crossoversStillGliding || smoother.isSmoothing();
         }
+    }
+    
+    if (crossoversMoved && numBands > 1)
+    {
+        const DspLoadMeter::ScopedUpdate updateMeasurement (dspLoad);
+        designCrossovers (! crossoversStillGliding);
+    }
+}
 
+template <typename SampleType>
+void NewProjectAudioProcessor::processSubBlock (SampleType* const* channels, int numChannels, int numSamples,
+                                                MeterFifo::Frame& meters, double* sumsOfSquares)
+{
+    if (currentFilterMode == smoothedFilterMode)
+        svfFilter.process (channels, numChannels, numSamples);
+    else if (currentFilterMode == linearPhaseFilterMode)
+        linearPhaseFilter.process (channels, numChannels, numSamples);
+    else
+        iirFilter.process (channels, numChannels, numSamples);
+    
+    processBands (channels, numChannels, numSamples);
+    
+    auto& clipper = std::get<OversampledClipper<SampleType>> (oversampledClippers);
+    auto useLimiter = currentClipMode == limiterMode;
+    auto clipAtBaseRate = ! useLimiter && ! clipper.isOversampling();
+    
+    //one ramp for every channel while the gain moves, none once it has settled
+    auto& gainSmoother = std::get<BlockSmoother<SampleType>> (gainSmoothers);
+    auto* gainRamp = gainSmoother.getNextBlock (numSamples);
+    auto gain = gainRamp != nullptr ? SampleType (1) : gainSmoother.getCurrentValue();
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (gainRamp != nullptr)
+            juce::FloatVectorOperations::multiply (channels[channel], gainRamp, numSamples);
         
+        //gain, metering and (base rate) hard clip in a single pass over the buffer
+        auto stats = clipAtBaseRate
+                   ? GainClipPeak::process (channels[channel], numSamples, gain)
+                   : GainClipPeak::processWithoutClip (channels[channel], numSamples, gain);
+        
+        meters.peak[channel] = juce::jmax (meters.peak[channel], (float) stats.peak);
+        meters.numOvers[channel] += stats.numOvers;
+        sumsOfSquares[channel] += (double) stats.sumOfSquares;
     }
     
-    meterLocalMaxVal.store (sumMaxVal / (float)numChannels);
+    //anti-aliased clip stage, or the limiter in its place
+    if (useLimiter)
+        limiter.process (channels, numChannels, numSamples);
+    else if (! clipAtBaseRate)
+        clipper.process (channels, numChannels, numSamples);
+}
+
+template <typename SampleType>
+void NewProjectAudioProcessor::processBands (SampleType* const* channels, int numChannels, int numSamples)
+{
+    auto& smoothers = std::get<std::array<BlockSmoother<SampleType>, maxNumBands>> (bandGainSmoothers);
+    
+    if (numBands <= 1)
+    {
+        for (auto& smoother : smoothers)
+            smoother.skip (numSamples);
+        
+        return;
+    }
+    
+    //no band of the tree peaks higher than this times its input (the sum of its
+    //impulse response, worst case with all the splits on top of each other)
+    constexpr auto maxBandToInputPeak = SampleType (5);
+    
+    auto bandsAtUnity = true, crossoversSettled = true;
+    
+    for (int band = 0; band < numBands; ++band)
+        bandsAtUnity = bandsAtUnity && ! smoothers[(size_t) band].isSmoothing() && smoothers[(size_t) band].getCurrentValue() == SampleType (1);
+    
+    for (int split = 0; split < numBands - 1; ++split)
+        crossoversSettled = crossoversSettled && ! crossoverSmoothers[(size_t) split].isSmoothing();
+    
+    //one scan of the input instead of one per band: if it can't take a band over 0 dBFS,
+    //the bands at unity have nothing to do
+    auto inputPeak = SampleType (0);
+    
+    if (bandsAtUnity)
+        for (int channel = 0; channel < numChannels; ++channel)
+            inputPeak = juce::jmax (inputPeak, juce::FloatVectorOperations::findAbsoluteMaximum (channels[channel], numSamples));
+    
+    auto bandsAreTransparent = bandsAtUnity && inputPeak * maxBandToInputPeak <= SampleType (1);
+    auto canBypass = bandsAreTransparent && crossoversSettled;
+    auto switchLength = (int) std::ceil (crossoverTailInSamples);
+    
+    if (crossoverState == splitting && canBypass)
+    {
+        crossoverSum.reset();
+        crossoverState = enteringBypass;
+        crossoverStateCountdown = switchLength;
+    }
+    else if (crossoverState == enteringBypass && ! canBypass)
+    {
+        crossoverState = splitting;
+    }
+    else if (crossoverState == enteringBypass && crossoverStateCountdown <= 0)
+    {
+        crossoverState = bypassed;
+    }
+    else if (crossoverState == bypassed && ! canBypass)
+    {
+        //the tree restarts from silence; until it has caught up, it only adds what
+        //the bands change to the all-pass sum, which starts out as nothing
+        for (auto& filter : crossoverLowPasses)     filter.reset();
+        for (auto& filter : crossoverHighPasses)    filter.reset();
+        for (auto& filter : crossoverAllPasses)     filter.reset();
+        crossoverState = leavingBypass;
+        crossoverStateCountdown = switchLength;
+    }
+    else if (crossoverState == leavingBypass && crossoverStateCountdown <= 0)
+    {
+        crossoverState = splitting;
+    }
+    
+    if (crossoverState == enteringBypass || crossoverState == leavingBypass)
+        crossoverStateCountdown -= numSamples;
+    
+    if (crossoverState == bypassed)
+    {
+        crossoverSum.process (channels, numChannels, numSamples);
+        return;
+    }
+    
+    //[band][channel]; what is left above the last split stays in channels as the top band
+    auto* const* bands = std::get<juce::AudioBuffer<SampleType>> (bandBuffers).getArrayOfWritePointers();
+    auto* const* sum = bands + (maxNumBands - 1) * numChannels;
+    auto runSum = crossoverState != splitting;
+    
+    if (runSum)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::copy (sum[channel], channels[channel], numSamples);
+        
+        crossoverSum.process (sum, numChannels, numSamples);
+    }
+    
+    for (int split = 0; split < numBands - 1; ++split)
+    {
+        auto* const* band = bands + split * numChannels;
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::copy (band[channel], channels[channel], numSamples);
+        
+        crossoverLowPasses[(size_t) split].process (band, numChannels, numSamples);
+        crossoverHighPasses[(size_t) split].process (channels, numChannels, numSamples);
+        
+        //every band and channel below this split runs as a lane of the same all-pass
+        if (split > 0)
+            crossoverAllPasses[(size_t) split - 1].process (bands, split * numChannels, numSamples);
+    }
+    
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto* const* bandChannels = band < numBands - 1 ? bands + band * numChannels : channels;
+        auto& smoother = smoothers[(size_t) band];
+        auto* gainRamp = smoother.getNextBlock (numSamples);
+        auto gain = gainRamp != nullptr ? SampleType (1) : smoother.getCurrentValue();
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = bandChannels[channel];
+            
+            if (crossoverState == leavingBypass)
+                juce::FloatVectorOperations::subtract (sum[channel], data, numSamples);
+            
+            if (bandsAreTransparent)
+                continue;
+            
+            if (gainRamp != nullptr)
+                juce::FloatVectorOperations::multiply (data, gainRamp, numSamples);
+            
+            GainClipPeak::process (data, numSamples, gain);
+        }
+    }
+    
+    for (int band = 0; band < numBands - 1; ++band)
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::add (channels[channel], bands[band * numChannels + channel], numSamples);
+    
+    if (crossoverState == leavingBypass)
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::add (channels[channel], sum[channel], numSamples);
+}
+
+void NewProjectAudioProcessor::setAutomationGranularity (int numSamples) noexcept
+{
+    automationGranularity = juce::jmax (0, numSamples);
+}
+
+int NewProjectAudioProcessor::getAutomationGranularity() const noexcept
+{
+    return automationGranularity.load();
 }
 
 //==============================================================================
@@ -241,10 +803,16 @@ void NewProjectAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
     
-    juce::ValueTree copyState = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml = copyState.createXml();
-    copyXmlToBinary(*xml.get(), destData);
+    //compact binary, see StateFormat.h
+    //the values the DSP runs on, which include a program the host hasn't been told about yet
+    StateFormat::ParameterValues values;
+    auto& parameters = getParameters();
+    
+    for (int i = 0; i < parameters.size(); ++i)
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameters.getUnchecked (i)))
+            values.emplace_back (ranged->paramID, dspParameterValues[(size_t) i].load());
     
+    StateFormat::write (values, destData);
 }
 
 void NewProjectAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -252,9 +820,56 @@ void NewProjectAudioProcessor::setStateInformation (const void* data, int sizeIn
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
     
-    std::unique_ptr<juce::XmlElement> xml = getXmlFromBinary(data, sizeInBytes);
-    juce::ValueTree copyState = juce::ValueTree::fromXml(*xml.get());
-    apvts.replaceState(copyState);
+    //reads the binary format and legacy XML sessions; malformed data changes nothing
+    StateFormat::ParameterValues values;
+    
+    if (! StateFormat::read (data, sizeInBytes, apvts.state.getType(), values))
+        return;
+    
+    //every value is resolved first; those missing from the state go back to their default
+    auto& parameters = getParameters();
+    std::vector<float> newValues ((size_t) parameters.size());
+    
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto* parameter = parameters.getUnchecked (i);
+        newValues[(size_t) i] = parameter->getValue();
+        
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+        {
+            newValues[(size_t) i] = ranged->getDefaultValue();
+            
+            for (auto& value : values)
+                if (value.first == ranged->paramID)
+                    newValues[(size_t) i] = ranged->convertTo0to1 (value.second);
+        }
+    }
+    
+    //the DSP gets the whole state before any stage is flagged, so it never runs a
+    //half-restored one, and it picks everything up in a single update
+    for (int i = 0; i < parameters.size(); ++i)
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameters.getUnchecked (i)))
+            dspParameterValues[(size_t) i] = ranged->convertFrom0to1 (newValues[(size_t) i]);
+    
+    mustUpdateFilter = true;
+    mustUpdateVolume = true;
+    mustUpdateClipper = true;
+    mustUpdateBands = true;
+    
+    //then the host and the editor; parameterChanged() has nothing left to flag
+    isRestoringState = true;
+    
+    for (int i = 0; i < parameters.size(); ++i)
+        if (newValues[(size_t) i] != parameters.getUnchecked (i)->getValue())
+            parameters.getUnchecked (i)->setValueNotifyingHost (newValues[(size_t) i]);
+    
+    isRestoringState = false;
+    
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        linearPhaseFilter.setEnabled ((int) filterModeValue->load() == linearPhaseFilterMode);
+        prepareClipperMode();
+    }
 }
 
 //==============================================================================
@@ -273,38 +888,439 @@ void NewProjectAudioProcessor::init()
 void NewProjectAudioProcessor::prepare (double sampleRate, int samplesPerBlock)
 {
     // pass to DSP
+    
+    auto numChannels = juce::jmin (getTotalNumInputChannels(), getTotalNumOutputChannels());
+    
+    iirFilter.prepare (numChannels, samplesPerBlock);
+    svfFilter.prepare (sampleRate, numChannels, findSmoothingSpec ("LPF")->seconds);
+    
+    //designs the first kernel from the current settings before any audio arrives;
+    //its design thread only runs in the linear-phase mode
+    linearPhaseFilter.setTarget ((int) filterTypeValue->load(), lpfValue->load());
+    linearPhaseFilter.setEnabled ((int) filterModeValue->load() == linearPhaseFilterMode);
+    linearPhaseFilter.prepare (sampleRate, numChannels);
+    
+    //only the selected oversampler is built, the others when they're picked
+    auto oversamplingFactor = (int) oversamplingFactorValue->load();
+    auto oversamplingFilter = (int) oversamplingFilterValue->load();
+    
+    if (isUsingDoublePrecision())
+        std::get<OversampledClipper<double>> (oversampledClippers).prepare (numChannels, samplesPerBlock, oversamplingFactor, oversamplingFilter);
+    else
+        std::get<OversampledClipper<float>> (oversampledClippers).prepare (numChannels, samplesPerBlock, oversamplingFactor, oversamplingFilter);
+    limiter.prepare (sampleRate, numChannels);
+    
+    maxSubBlockSize = juce::jmax (1, samplesPerBlock);
+    
+    for (int split = 0; split < maxNumBands - 1; ++split)
+    {
+        crossoverLowPasses[(size_t) split].prepare (numChannels, maxSubBlockSize);
+        crossoverHighPasses[(size_t) split].prepare (numChannels, maxSubBlockSize);
+        
+        if (split > 0)
+            crossoverAllPasses[(size_t) split - 1].prepare (split * numChannels, maxSubBlockSize);
+    }
+    
+    crossoverSum.prepare (numChannels, maxSubBlockSize);
+    crossoverState = splitting;
+    
+    //only the buffer for the current precision is allocated
+    auto numBandChannels = maxNumBands * numChannels;
+    std::get<juce::AudioBuffer<float>> (bandBuffers).setSize (isUsingDoublePrecision() ? 0 : numBandChannels, maxSubBlockSize);
+    std::get<juce::AudioBuffer<double>> (bandBuffers).setSize (isUsingDoublePrecision() ? numBandChannels : 0, maxSubBlockSize);
+    
+    for (int band = 0; band < maxNumBands; ++band)
+    {
+        auto bandGain = juce::Decibels::decibelsToGain (bandGainValues[(size_t) band]->load());
+        prepareSmoother (std::get<0> (bandGainSmoothers)[(size_t) band], bandGainIDs[band], bandGain, sampleRate, maxSubBlockSize);
+        prepareSmoother (std::get<1> (bandGainSmoothers)[(size_t) band], bandGainIDs[band], (double) bandGain, sampleRate, maxSubBlockSize);
+        
+        if (band < maxNumBands - 1)
+            prepareSmoother (crossoverSmoothers[(size_t) band], crossoverIDs[band], crossoverValues[(size_t) band]->load(), sampleRate, maxSubBlockSize);
+    }
+
+    auto gain = juce::Decibels::decibelsToGain (volumeValue->load());
+    prepareSmoother (std::get<BlockSmoother<float>> (gainSmoothers), "VOL", gain, sampleRate, maxSubBlockSize);
+    prepareSmoother (std::get<BlockSmoother<double>> (gainSmoothers), "VOL", (double) gain, sampleRate, maxSubBlockSize);
+    prepareSmoother (cutoffSmoother, "LPF", lpfValue->load(), sampleRate, maxSubBlockSize);
+    prepareSmoother (lfoRateSmoother, "LFORATE", lfoRateValue->load(), sampleRate, maxSubBlockSize);
+    prepareSmoother (lfoDepthSmoother, "LFODEPTH", lfoDepthValue->load(), sampleRate, maxSubBlockSize);
+    prepareSmoother (releaseSmoother, "LIMREL", limiterReleaseValue->load(), sampleRate, maxSubBlockSize);
+    
+    std::get<0> (programFaders).prepare (sampleRate, maxSubBlockSize, BlockSmoother<float>::linear, programFadeSeconds);
+    std::get<1> (programFaders).prepare (sampleRate, maxSubBlockSize, BlockSmoother<double>::linear, programFadeSeconds);
+    std::get<0> (programFaders).setCurrentAndTargetValue (1.0f);
+    std::get<1> (programFaders).setCurrentAndTargetValue (1.0);
+    programFade = notFading;
+    
+    //offline renders can outrun the meter thread, so they are measured inline,
+    //unless nobody reads the measurements
+    isAnalysingOutput = outputAnalysisEnabled;
+    
+    if (isAnalysingOutput)
+        loudnessMeter.prepare (sampleRate, getChannelLayoutOfBus (false, 0), isNonRealtime());
+    else
+        loudnessMeter.release();
+    
+    spectrumAnalyzer.prepare (sampleRate, numChannels);
+    dspLoad.prepare (sampleRate);
+}
+
+template <typename FloatType>
+void NewProjectAudioProcessor::prepareSmoother (BlockSmoother<FloatType>& smoother, const char* parameterID, FloatType initialValue,
+                                                double sampleRate, int samplesPerBlock)
+{
+    //parameters without a spec jump
+    auto curve = BlockSmoother<FloatType>::linear;
+    auto seconds = 0.0;
+    
+    if (auto* spec = findSmoothingSpec (parameterID))
+    {
+        curve = (typename BlockSmoother<FloatType>::Curve) (int) spec->curve;
+        seconds = spec->seconds;
+    }
+    
+    smoother.prepare (sampleRate, samplesPerBlock, curve, seconds);
+    smoother.setCurrentAndTargetValue (initialValue);
 }
 
 void NewProjectAudioProcessor::update()
 {
     //update DSP when user changes params
     
-    mustUpdateProcessing = false;
+    mustUpdateFilter = false;
+    mustUpdateVolume = false;
+    mustUpdateClipper = false;
+    mustUpdateBands = false;
+    
+    const DspLoadMeter::ScopedUpdate updateMeasurement (dspLoad);
+    
+    updateFilter();
+    updateVolume();
+    updateClipper();
+    updateBands();
+    
+    //never called on the audio thread, so the latency can be reported straight away
+    setLatencySamples (pendingLatency.load());
+}
+
+void NewProjectAudioProcessor::updateFilter()
+{
+    auto mode = (int) filterModeValue->load();
+    
+    //the continuous settings glide, see advanceControlSmoothers(). The SVF glides its
+    //cutoff itself at control rate, so it's handed the target straight away
+    if (mode == smoothedFilterMode)
+        cutoffSmoother.setCurrentAndTargetValue (lpfValue->load());
+    else
+        cutoffSmoother.setTargetValue (lpfValue->load());
     
+    lfoRateSmoother.setTargetValue (lfoRateValue->load());
+    lfoDepthSmoother.setTargetValue (lfoDepthValue->load());
     
-    auto frequency = apvts.getRawParameterValue("LPF");
-    auto volume = apvts.getRawParameterValue("VOL");
+    //switching filters: start the new one from silence
+    if (mode != currentFilterMode)
+    {
+        iirFilter.reset();
+        svfFilter.reset();
+        linearPhaseFilter.reset();
+        currentFilterMode = mode;
+    }
     
+    designFilter();
+}
+
+void NewProjectAudioProcessor::designFilter (bool updateTail)
+{
+    //not prepared yet
+    if (getSampleRate() <= 0.0)
+        return;
+    
+    auto frequency = cutoffSmoother.getCurrentValue();
+    auto lfoDepth = lfoDepthSmoother.getCurrentValue();
+    auto mode = currentFilterMode;
+    
+    svfFilter.setCutoffFrequency (frequency);
+    svfFilter.setPassType ((int) filterTypeValue->load());
+    svfFilter.setLfo (lfoRateSmoother.getCurrentValue(), lfoDepth);
     
-    for (int channel = 0; channel < 2; ++channel)
+    //only flags the design thread, the kernel is crossfaded in when it's ready.
+    //No kernels are designed for the other modes
+    if (mode == linearPhaseFilterMode)
+        linearPhaseFilter.setTarget ((int) filterTypeValue->load(), frequency);
+    
+    filterLatency = mode == linearPhaseFilterMode ? LinearPhaseFilter::getLatencyInSamples() : 0;
+    
+    if (mode == biquadFilterMode)
     {
-        iirFilter[channel].setCoefficients (juce::IIRCoefficients::makeLowPass(getSampleRate(), frequency->load()));
-        outputVolume[channel].setTargetValue (juce::Decibels::decibelsToGain (volume->load()));
+        MultiChannelBiquad::Coefficients sections[MultiChannelBiquad::maxNumSections];
+        
+        auto numSections = MultiChannelBiquad::designCascade (sections,
+                                                              (MultiChannelBiquad::PassType) (int) filterTypeValue->load(),
+                                                              (MultiChannelBiquad::Response) (int) filterResponseValue->load(),
+                                                              (MultiChannelBiquad::Slope) (int) filterSlopeValue->load(),
+                                                              getSampleRate(),
+                                                              juce::jmin ((double) frequency, getSampleRate() * 0.49));
+        
+        iirFilter.setCoefficients (sections, numSections);
+        
+        if (updateTail)
+            filterTailInSamples = MultiChannelBiquad::getDecayTimeInSamples (sections, numSections, 120.0);
+    }
+    else if (mode == linearPhaseFilterMode)
+    {
+        //the half of the kernel after its centre
+        filterTailInSamples = LinearPhaseFilter::kernelLength / 2;
+    }
+    else if (updateTail)
+    {
+        //the SVF is a Butterworth pair; it rings longest at the bottom of the LFO sweep
+        auto lowestFrequency = juce::jmax (10.0, frequency * std::exp2 (-(double) lfoDepth));
+        auto poles = MultiChannelBiquad::Coefficients::makeLowPass (getSampleRate(), juce::jmin (lowestFrequency, getSampleRate() * 0.45));
+        filterTailInSamples = MultiChannelBiquad::getDecayTimeInSamples (&poles, 1, 120.0);
     }
+    
+    updateLatencyAndTail();
+}
+
+void NewProjectAudioProcessor::updateVolume()
+{
+    auto gain = juce::Decibels::decibelsToGain (volumeValue->load());
+    
+    std::get<BlockSmoother<float>> (gainSmoothers).setTargetValue (gain);
+    std::get<BlockSmoother<double>> (gainSmoothers).setTargetValue ((double) gain);
+}
+
+void NewProjectAudioProcessor::prepareClipperMode()
+{
+    auto factor = (int) oversamplingFactorValue->load();
+    auto filterType = (int) oversamplingFilterValue->load();
+    
+    auto built = isUsingDoublePrecision() ? std::get<OversampledClipper<double>> (oversampledClippers).prepareMode (factor, filterType)
+                                          : std::get<OversampledClipper<float>> (oversampledClippers).prepareMode (factor, filterType);
+    
+    //the audio thread kept the previous mode until now
+    if (built)
+        mustUpdateClipper = true;
+}
+
+void NewProjectAudioProcessor::updateClipper()
+{
+    auto factor = (int) oversamplingFactorValue->load();
+    auto filterType = (int) oversamplingFilterValue->load();
+    
+    auto mode = (int) clipModeValue->load();
+    
+    std::get<OversampledClipper<float>> (oversampledClippers).setMode (factor, filterType);
+    std::get<OversampledClipper<double>> (oversampledClippers).setMode (factor, filterType);
+    releaseSmoother.setTargetValue (limiterReleaseValue->load());
+    limiter.setParameters (limiterLookaheadValue->load(), releaseSmoother.getCurrentValue());
+    
+    //switching to the limiter: start its delay line from silence
+    if (mode != currentClipMode)
+    {
+        limiter.reset();
+        currentClipMode = mode;
+    }
+    
+    if (mode == limiterMode)
+        clipLatency = limiter.getLatencyInSamples();
+    else
+        clipLatency = isUsingDoublePrecision() ? std::get<OversampledClipper<double>> (oversampledClippers).getLatencyInSamples()
+                                               : std::get<OversampledClipper<float>> (oversampledClippers).getLatencyInSamples();
+    
+    updateLatencyAndTail();
+}
+
+void NewProjectAudioProcessor::updateBands()
+{
+    auto newNumBands = (int) numBandsValue->load() + 1;
+    
+    //the crossovers and band gains glide, see advanceControlSmoothers()
+    for (int split = 0; split < maxNumBands - 1; ++split)
+        crossoverSmoothers[(size_t) split].setTargetValue (crossoverValues[(size_t) split]->load());
+    
+    for (int band = 0; band < maxNumBands; ++band)
+    {
+        auto gain = juce::Decibels::decibelsToGain (bandGainValues[(size_t) band]->load());
+        std::get<0> (bandGainSmoothers)[(size_t) band].setTargetValue (gain);
+        std::get<1> (bandGainSmoothers)[(size_t) band].setTargetValue ((double) gain);
+    }
+    
+    //changing the number of bands: start the splits from silence
+    if (newNumBands != numBands)
+    {
+        for (auto& filter : crossoverLowPasses)     filter.reset();
+        for (auto& filter : crossoverHighPasses)    filter.reset();
+        for (auto& filter : crossoverAllPasses)     filter.reset();
+        crossoverSum.reset();
+        numBands = newNumBands;
+    }
+    
+    designCrossovers();
+}
+
+void NewProjectAudioProcessor::designCrossovers (bool updateTail)
+{
+    //not prepared yet
+    auto sampleRate = getSampleRate();
+    
+    if (sampleRate <= 0.0)
+        return;
+    
+    auto tailInSamples = 0.0;
+    auto previousFrequency = 10.0;
+    
+    static_assert (maxNumBands - 1 <= MultiChannelBiquad::maxNumSections, "one all-pass section per split");
+    MultiChannelBiquad::Coefficients allPasses[maxNumBands - 1];
+    
+    for (int split = 0; split < numBands - 1; ++split)
+    {
+        //keep the splits in order and below Nyquist, whatever the parameters say
+        auto frequency = juce::jlimit (previousFrequency, sampleRate * 0.45, (double) crossoverSmoothers[(size_t) split].getCurrentValue());
+        previousFrequency = frequency;
+        
+        MultiChannelBiquad::Coefficients sections[MultiChannelBiquad::maxNumSections];
+        
+        auto numSections = MultiChannelBiquad::designCascade (sections, MultiChannelBiquad::lowPass, MultiChannelBiquad::linkwitzRiley,
+                                                              MultiChannelBiquad::slope24dB, sampleRate, frequency);
+        crossoverLowPasses[(size_t) split].setCoefficients (sections, numSections);
+        
+        if (updateTail)
+            tailInSamples += MultiChannelBiquad::getDecayTimeInSamples (sections, numSections, 120.0);
+        
+        numSections = MultiChannelBiquad::designCascade (sections, MultiChannelBiquad::highPass, MultiChannelBiquad::linkwitzRiley,
+                                                         MultiChannelBiquad::slope24dB, sampleRate, frequency);
+        crossoverHighPasses[(size_t) split].setCoefficients (sections, numSections);
+        
+        //the bands split off below get the same phase shift as the ones above them
+        allPasses[split] = MultiChannelBiquad::Coefficients::makeAllPass (sampleRate, frequency);
+        
+        if (split > 0)
+            crossoverAllPasses[(size_t) split - 1].setCoefficients (allPasses[split]);
+    }
+    
+    if (numBands > 1)
+        crossoverSum.setCoefficients (allPasses, numBands - 1);
+    
+    if (updateTail)
+        crossoverTailInSamples = tailInSamples;
+    
+    updateLatencyAndTail();
+}
+
+void NewProjectAudioProcessor::updateLatencyAndTail() noexcept
+{
+    //setLatencySamples notifies the host under a lock, so it can't be called from here
+    pendingLatency = filterLatency + clipLatency;
+    
+    auto sampleRate = getSampleRate();
+    
+    if (sampleRate > 0.0)
+        tailLengthSeconds = (filterTailInSamples + crossoverTailInSamples + pendingLatency.load()) / sampleRate;
+}
+
+void NewProjectAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
+{
+    //detect when a user changes params - can be called from any thread.
+    //A state being restored is already staged, see setStateInformation()
+    if (isRestoringState)
+        return;
+    
+    if (auto* parameter = apvts.getParameter (parameterID))
+        dspParameterValues[(size_t) parameter->getParameterIndex()] = newValue;
+    
+    if (parameterID == "LPF" || parameterID == "FMODE" || parameterID == "FTYPE" || parameterID == "FSLOPE"
+         || parameterID == "FRESP" || parameterID == "LFORATE" || parameterID == "LFODEPTH")
+    {
+        mustUpdateFilter = true;
+        
+        //from the editor, start or stop the design thread now rather than on the next tick
+        if (parameterID == "FMODE" && juce::MessageManager::existsAndIsCurrentThread())
+            linearPhaseFilter.setEnabled ((int) newValue == linearPhaseFilterMode);
+    }
+    else if (parameterID == "VOL")
+        mustUpdateVolume = true;
+    else if (parameterID == "OSFACTOR" || parameterID == "OSFILTER" || parameterID == "CLIPMODE"
+              || parameterID == "LIMLOOK" || parameterID == "LIMREL")
+    {
+        mustUpdateClipper = true;
+        
+        //from the editor, build the newly picked oversampler now rather than on the next tick
+        if ((parameterID == "OSFACTOR" || parameterID == "OSFILTER") && juce::MessageManager::existsAndIsCurrentThread())
+            prepareClipperMode();
+    }
+    else if (parameterID == "BANDS" || parameterID.startsWith ("XOVER") || parameterID.startsWith ("BGAIN"))
+        mustUpdateBands = true;
+}
+
+void NewProjectAudioProcessor::timerCallback()
+{
+    //programs the audio thread has applied
+    publishProgram();
+    
+    //the meter thread sleeps while its queue is empty
+    loudnessMeter.handlePendingAudio();
+    
+    //the linear-phase design thread runs only in its mode, and can't be woken from the audio thread
+    linearPhaseFilter.setEnabled ((int) filterModeValue->load() == linearPhaseFilterMode);
+    linearPhaseFilter.handlePendingTarget();
+    
+    //oversamplers can't be built on the audio thread
+    prepareClipperMode();
+    
+    auto latency = pendingLatency.load();
+    
+    if (latency != getLatencySamples())
+        setLatencySamples (latency);
 }
 
 void NewProjectAudioProcessor::reset()
 {
     //reset DSP params
     
-    for (int channel = 0; channel < 2; ++channel)
+    iirFilter.reset();
+    svfFilter.reset();
+    linearPhaseFilter.reset();
+    std::get<0> (oversampledClippers).reset();
+    std::get<1> (oversampledClippers).reset();
+    limiter.reset();
+    
+    //glides jump to where they were heading
+    std::get<0> (gainSmoothers).setCurrentAndTargetValue (std::get<0> (gainSmoothers).getTargetValue());
+    std::get<1> (gainSmoothers).setCurrentAndTargetValue (std::get<1> (gainSmoothers).getTargetValue());
+    
+    for (auto* smoother : { &cutoffSmoother, &lfoRateSmoother, &lfoDepthSmoother, &releaseSmoother })
+        smoother->setCurrentAndTargetValue (smoother->getTargetValue());
+    
+    for (int band = 0; band < maxNumBands; ++band)
+    {
+        auto& floatSmoother = std::get<0> (bandGainSmoothers)[(size_t) band];
+        auto& doubleSmoother = std::get<1> (bandGainSmoothers)[(size_t) band];
+        floatSmoother.setCurrentAndTargetValue (floatSmoother.getTargetValue());
+        doubleSmoother.setCurrentAndTargetValue (doubleSmoother.getTargetValue());
+    }
+    
+    for (int split = 0; split < maxNumBands - 1; ++split)
     {
-        iirFilter[channel].reset();
-        outputVolume[channel].reset (getSampleRate(), 0.050);
+        auto& smoother = crossoverSmoothers[(size_t) split];
+        smoother.setCurrentAndTargetValue (smoother.getTargetValue());
+        
+        crossoverLowPasses[(size_t) split].reset();
+        crossoverHighPasses[(size_t) split].reset();
     }
     
-    meterLocalMaxVal.store (0.0f);
-    meterGlobalMaxVal.store (0.0f);
+    for (auto& allPass : crossoverAllPasses)
+        allPass.reset();
+    
+    crossoverSum.reset();
+    
+    designFilter();
+    designCrossovers();
+    limiter.setParameters (limiterLookaheadValue->load(), releaseSmoother.getCurrentValue());
+    
+    isIdle = false;
+    numSilentSamples = 0;
 }
 
 //void NewProjectAudioProcessor::userChangedParameter()
@@ -313,6 +1329,35 @@ void NewProjectAudioProcessor::reset()
 //
 //}
 
+const NewProjectAudioProcessor::SmoothingSpec* NewProjectAudioProcessor::findSmoothingSpec (const char* parameterID) noexcept
+{
+    //smoothing of the continuous parameters created below. LIMLOOK isn't smoothed:
+    //it changes the latency, so it can only jump
+    static const SmoothingSpec specs[] =
+    {
+        { "VOL",      BlockSmoother<float>::multiplicative, 0.050 },
+        { "LPF",      BlockSmoother<float>::multiplicative, 0.050 },
+        { "LFORATE",  BlockSmoother<float>::onePole,        0.200 },
+        { "LFODEPTH", BlockSmoother<float>::linear,         0.100 },
+        { "LIMREL",   BlockSmoother<float>::onePole,        0.100 },
+        { "XOVER1",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "XOVER2",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "XOVER3",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "XOVER4",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "BGAIN1",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "BGAIN2",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "BGAIN3",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "BGAIN4",   BlockSmoother<float>::multiplicative, 0.050 },
+        { "BGAIN5",   BlockSmoother<float>::multiplicative, 0.050 }
+    };
+    
+    for (auto& spec : specs)
+        if (std::strcmp (spec.parameterID, parameterID) == 0)
+            return &spec;
+    
+    return nullptr;
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout NewProjectAudioProcessor::createParameters()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> parameters;
@@ -328,8 +1373,42 @@ juce::AudioProcessorValueTreeState::ParameterLayout NewProjectAudioProcessor::cr
     //filter/////////////////////
     parameters.push_back (std::make_unique<juce::AudioParameterFloat>("LPF", "Low Pass Filter", juce::NormalisableRange<float> (20.0f, 22000.0f, 10.0f, 0.2f), 800.0f, "Hz", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
     
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("FMODE", "Filter Mode", juce::StringArray { "Biquad", "Smoothed SVF", "Linear phase" }, biquadFilterMode));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("FTYPE", "Filter Type", juce::StringArray { "Low-pass", "High-pass" }, MultiChannelBiquad::lowPass));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("FSLOPE", "Filter Slope", juce::StringArray { "12 dB/oct", "24 dB/oct", "36 dB/oct", "48 dB/oct" }, MultiChannelBiquad::slope12dB));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("FRESP", "Filter Response", juce::StringArray { "Butterworth", "Linkwitz-Riley" }, MultiChannelBiquad::butterworth));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat>("LFORATE", "Filter LFO Rate", juce::NormalisableRange<float> (0.01f, 20.0f, 0.01f, 0.3f), 1.0f, "Hz", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat>("LFODEPTH", "Filter LFO Depth", juce::NormalisableRange<float> (0.0f, 4.0f, 0.01f), 0.0f, "oct", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
+    
     parameters.push_back (std::make_unique<juce::AudioParameterFloat>("VOL", "Volume", juce::NormalisableRange< float > (-40.0f, 40.0f), 0.0f, "dB", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
     
+    //clipper/////////////////////
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("OSFACTOR", "Clip Oversampling", juce::StringArray { "Off", "2x", "4x", "8x" }, 0));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("OSFILTER", "Oversampling Filter", juce::StringArray { "Low latency IIR", "Linear phase FIR" }, 0));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("CLIPMODE", "Output Stage", juce::StringArray { "Hard clip", "Limiter" }, hardClipMode));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat>("LIMLOOK", "Limiter Lookahead", juce::NormalisableRange<float> (0.1f, LookaheadLimiter::maxLookaheadMilliseconds, 0.01f, 0.5f), 1.5f, "ms", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
+    
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat>("LIMREL", "Limiter Release", juce::NormalisableRange<float> (1.0f, 1000.0f, 0.1f, 0.3f), 100.0f, "ms", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
+    
+    //multiband/////////////////////
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice>("BANDS", "Bands", juce::StringArray { "Off", "2 bands", "3 bands", "4 bands", "5 bands" }, 0));
+    
+    const float crossoverDefaults[] = { 120.0f, 500.0f, 2000.0f, 6000.0f };
+    
+    for (int split = 0; split < maxNumBands - 1; ++split)
+        parameters.push_back (std::make_unique<juce::AudioParameterFloat>(crossoverIDs[split], "Crossover " + juce::String (split + 1), juce::NormalisableRange<float> (20.0f, 20000.0f, 1.0f, 0.2f), crossoverDefaults[split], "Hz", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
+    
+    for (int band = 0; band < maxNumBands; ++band)
+        parameters.push_back (std::make_unique<juce::AudioParameterFloat>(bandGainIDs[band], "Band " + juce::String (band + 1) + " Gain", juce::NormalisableRange<float> (-24.0f, 24.0f, 0.1f), 0.0f, "dB", juce::AudioProcessorParameter::genericParameter, valueToTextFunction, textToValueFunction));
+    
     
     
     return { parameters.begin(), parameters.end() };
@@ -9,12 +9,24 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MultiChannelBiquad.h"
+#include "ModulatedStateVariableFilter.h"
+#include "LinearPhaseFilter.h"
+#include "OversampledClipper.h"
+#include "LookaheadLimiter.h"
+#include "MeterFifo.h"
+#include "LoudnessMeter.h"
+#include "SpectrumAnalyzer.h"
+#include "DspLoadMeter.h"
+#include "BlockSmoother.h"
+#include "PresetBank.h"
 
 //==============================================================================
 /**
 */
 class NewProjectAudioProcessor  : public juce::AudioProcessor,
-                                  public juce::ValueTree::Listener
+                                  public juce::AudioProcessorValueTreeState::Listener,
+                                  private juce::Timer
 {
 public:
     //==============================================================================
@@ -30,6 +42,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -59,29 +73,214 @@ public:
     void init(); // Called once - give initial values to DSP
     void prepare (double sampleRate, int samplesPerBlock); // pass to DSP
     void update(); //update DSP when user changes params
+    void updateFilter(); //only the LPF stage
+    void updateVolume(); //only the gain stage
+    void updateClipper(); //only the clip stage
+    void updateBands(); //only the multiband stage
     void reset() override; //reset DSP params
     
     juce::AudioProcessorValueTreeState apvts;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
-    std::atomic<float> meterLocalMaxVal, meterGlobalMaxVal;
+    MeterFifo meterFifo; // one frame per block, drained by the editor
+    LoudnessMeter loudnessMeter; // LUFS and true-peak of the output, analysed on its own thread
+    SpectrumAnalyzer spectrumAnalyzer; // input and output spectrum, only runs while the editor enables it
+    
+    static constexpr int maxNumChannels = 16; // up to 3rd order ambisonics
+    static_assert (maxNumChannels <= MeterFifo::maxNumChannels, "every channel needs a meter");
+    
+    /** Parameter changes are applied every numSamples samples inside a host
+        block. 0 means only at host block boundaries. Safe to call from any thread.
+    */
+    void setAutomationGranularity (int numSamples) noexcept;
+    int getAutomationGranularity() const noexcept;
+    
+    static constexpr int defaultAutomationGranularity = 32;
+    
+    static constexpr int maxNumBands = 5; // "BANDS" choices are off, then 2 to maxNumBands
+    
+    /** Cost of processBlock relative to the real-time budget, and of the
+        slowest parameter update. Safe to call from any thread.
+    */
+    DspLoadMeter::Stats getDspLoad() const noexcept     { return dspLoad.getStats(); }
+    void resetDspLoad() noexcept                        { dspLoad.reset(); }
+    
+    /** Does what the 10 Hz timer does: publishes applied programs and the latency,
+        and wakes the meter and filter design threads. For headless drivers that
+        don't run a message loop. Must be called from the message thread.
+    */
+    void runTimerTasks()                                { timerCallback(); }
+    
+    /** Turns the loudness meter and spectrum analyzer off, for headless renders
+        where nobody reads them. Takes effect on the next prepareToPlay(), so it
+        must not be called while processing.
+    */
+    void setOutputAnalysisEnabled (bool shouldBeEnabled) noexcept   { outputAnalysisEnabled = shouldBeEnabled; }
+    
+    /** Adds the presets of a bank file (see PresetBank.h) to the programs.
+        Must be called from the message thread.
+    */
+    bool loadPresetBank (const juce::File& file);
+    
+    //choices of the "FMODE" parameter
+    enum FilterMode
+    {
+        biquadFilterMode = 0,   // Butterworth / Linkwitz-Riley biquad cascade, coefficients jump on change
+        smoothedFilterMode,     // TPT state variable filter, smoothed + LFO
+        linearPhaseFilterMode   // windowed-sinc FIR, partitioned FFT convolution
+    };
+    
+    //choices of the "CLIPMODE" parameter
+    enum ClipMode
+    {
+        hardClipMode = 0,       // per-sample clip, optionally oversampled
+        limiterMode             // lookahead true-peak limiter
+    };
     
     
 
 
 private:
-    bool mustUpdateProcessing { false };
+    //set from whichever thread changes a parameter, cleared by the audio thread
+    std::atomic<bool> mustUpdateFilter { true }, mustUpdateVolume { true }, mustUpdateClipper { true }, mustUpdateBands { true };
+    std::atomic<bool> isRestoringState { false }; //setStateInformation() notifies the host of values already staged
+    std::atomic<bool> outputAnalysisEnabled { true }; //see setOutputAnalysisEnabled()
+    bool isAnalysingOutput { true }; //outputAnalysisEnabled as of the last prepare, audio thread only
     bool isActive { false };
+    std::atomic<int> automationGranularity { defaultAutomationGranularity };
+    DspLoadMeter dspLoad;
     //float outputVolume { 0.0 };
     
-    juce::IIRFilter iirFilter [2];
+    //per-channel DSP state, sized in prepare() for the current layout
+    MultiChannelBiquad iirFilter;
+    ModulatedStateVariableFilter svfFilter;
+    LinearPhaseFilter linearPhaseFilter;
+    int currentFilterMode = biquadFilterMode;
     
-    juce::LinearSmoothedValue<float> outputVolume [2] { 0.0 };
+    //per-sample ramps for the gain, control-rate glides for the filter, LFO and release
+    std::tuple<BlockSmoother<float>, BlockSmoother<double>> gainSmoothers;
+    BlockSmoother<float> cutoffSmoother, lfoRateSmoother, lfoDepthSmoother, releaseSmoother;
+    int maxSubBlockSize = 0;
     
-    void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override
+    /** How a continuous parameter glides to a new value, declared with the parameters. */
+    struct SmoothingSpec
     {
-            //detect when a user changes params
-        mustUpdateProcessing = true;
-    }
+        const char* parameterID;
+        BlockSmoother<float>::Curve curve;
+        double seconds;
+    };
+    
+    static const SmoothingSpec* findSmoothingSpec (const char* parameterID) noexcept;
+    
+    template <typename FloatType>
+    void prepareSmoother (BlockSmoother<FloatType>& smoother, const char* parameterID, FloatType initialValue,
+                          double sampleRate, int samplesPerBlock);
+    
+    void advanceControlSmoothers (int numSamples);
+    void designFilter (bool updateTail = true); //applies the smoothed filter settings; the tail estimate only when updateTail is set
+    
+    //multiband: 4th order Linkwitz-Riley splits, the bands below each split get its
+    //all-pass so they all sum flat; each band has its own gain and clip
+    int numBands = 1;
+    std::array<MultiChannelBiquad, maxNumBands - 1> crossoverLowPasses, crossoverHighPasses;
+    std::array<MultiChannelBiquad, maxNumBands - 2> crossoverAllPasses; //[i] runs the i + 1 bands below split i + 1 as one filter
+    std::array<BlockSmoother<float>, maxNumBands - 1> crossoverSmoothers;
+    std::tuple<std::array<BlockSmoother<float>, maxNumBands>, std::array<BlockSmoother<double>, maxNumBands>> bandGainSmoothers;
+    std::tuple<juce::AudioBuffer<float>, juce::AudioBuffer<double>> bandBuffers; //[band][channel], all but the top band, then the unity sum
+    double crossoverTailInSamples = 0.0;
+    
+    //with every band at unity and no band able to clip, the bands add up to a cascade of
+    //the splits' all-passes, which runs instead of the whole tree. Whichever side is
+    //switched to has first run for the crossover tail alongside, so the switch is seamless
+    MultiChannelBiquad crossoverSum;
+    enum CrossoverState { splitting, enteringBypass, bypassed, leavingBypass };
+    CrossoverState crossoverState = splitting;
+    int crossoverStateCountdown = 0;
+    void designCrossovers (bool updateTail = true); //applies the smoothed crossover frequencies; the tail estimate only when updateTail is set
+    
+    template <typename SampleType>
+    void processBands (SampleType* const* channels, int numChannels, int numSamples);
+    
+    //one per sample type, only the one for the current precision is prepared
+    std::tuple<OversampledClipper<float>, OversampledClipper<double>> oversampledClippers;
+    void prepareClipperMode(); //builds the selected oversampler, message thread only
+    
+    LookaheadLimiter limiter;
+    int currentClipMode = hardClipMode;
+    
+    //programs, resolved to parameter values when the bank is built. The audio thread
+    //stages them straight into dspParameterValues, the host hears about them afterwards
+    PresetBank presetBank;
+    std::atomic<int> currentProgram { 0 };
+    std::atomic<int> programToApply { -1 };         // waiting for the audio thread
+    std::atomic<int> programToPublish { -1 };       // applied, waiting for the message thread
+    int pendingProgram = -1;                        // waiting for the fade-out to finish
+    std::vector<bool> parameterNeedsFade;           // modes and the lookahead reset DSP state
+    bool programNeedsFade (int index) const noexcept;
+    void stageProgram (int index) noexcept; //audio thread: the values and the update flags
+    void publishProgram(); //sends an applied program's values to the host
+    
+    //a program that switches a filter or clip mode is faded out, applied in silence and faded in
+    enum ProgramFade
+    {
+        notFading = 0,
+        fadingOut,
+        fadingIn
+    };
+    
+    int programFade = notFading;
+    std::tuple<BlockSmoother<float>, BlockSmoother<double>> programFaders;
+    static constexpr double programFadeSeconds = 0.005;
+    
+    template <typename SampleType>
+    void applyProgramFade (SampleType* const* channels, int numChannels, int numSamples);
+    
+    //the values the DSP runs on, one per parameter in parameter order: kept in step
+    //with the host by parameterChanged(), and written directly by a program switch
+    std::unique_ptr<std::atomic<float>[]> dspParameterValues;
+    
+    //cached so the audio thread never looks parameters up by name
+    std::atomic<float>* lpfValue = nullptr;
+    std::atomic<float>* volumeValue = nullptr;
+    std::atomic<float>* filterModeValue = nullptr;
+    std::atomic<float>* filterTypeValue = nullptr;
+    std::atomic<float>* filterSlopeValue = nullptr;
+    std::atomic<float>* filterResponseValue = nullptr;
+    std::atomic<float>* lfoRateValue = nullptr;
+    std::atomic<float>* lfoDepthValue = nullptr;
+    std::atomic<float>* oversamplingFactorValue = nullptr;
+    std::atomic<float>* oversamplingFilterValue = nullptr;
+    std::atomic<float>* clipModeValue = nullptr;
+    std::atomic<float>* limiterLookaheadValue = nullptr;
+    std::atomic<float>* limiterReleaseValue = nullptr;
+    std::atomic<float>* numBandsValue = nullptr;
+    std::array<std::atomic<float>*, maxNumBands - 1> crossoverValues;
+    std::array<std::atomic<float>*, maxNumBands> bandGainValues;
+    
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    
+    //latency worked out on the audio thread, reported to the host from the message thread
+    std::atomic<int> pendingLatency { 0 };
+    int filterLatency = 0, clipLatency = 0;
+    
+    //idle skip: once the input is silent and the tail has died away the chain is bypassed
+    bool isIdle = false;
+    int numSilentSamples = 0;
+    double filterTailInSamples = 0.0;
+    std::atomic<double> tailLengthSeconds { 0.0 };
+    static constexpr float silenceThreshold = 1.0e-6f; // -120 dBFS
+    void clearState() noexcept; //on going idle: clears the filter state, no redesign
+    void updateLatencyAndTail() noexcept;
+    void timerCallback() override;
+    
+    void applyPendingUpdates();
+    
+    //float and double buffers share one implementation
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer);
+    
+    template <typename SampleType>
+    void processSubBlock (SampleType* const* channels, int numChannels, int numSamples,
+                          MeterFifo::Frame& meters, double* sumsOfSquares);
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NewProjectAudioProcessor)
 };
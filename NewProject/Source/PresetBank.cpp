@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+namespace
+{
+    constexpr juce::uint32 magic = 0x4b42504e;   // "NPBK" when read as bytes
+    constexpr int currentVersion = 1;
+
+    struct FactoryPreset
+    {
+        const char* name;
+        std::initializer_list<std::pair<const char*, float>> values;   // only what differs from the defaults
+    };
+
+    const FactoryPreset factoryPresets[] =
+    {
+        { "Init",           {} },
+        { "Warm Low-pass",  { { "LPF", 2500.0f }, { "FSLOPE", 1.0f } } },
+        { "Rumble Cut",     { { "FTYPE", 1.0f }, { "LPF", 30.0f }, { "FSLOPE", 3.0f }, { "FRESP", 1.0f } } },
+        { "Slow Sweep",     { { "FMODE", 1.0f }, { "LPF", 1200.0f }, { "LFORATE", 0.25f }, { "LFODEPTH", 2.0f } } },
+        { "Driven Clip",    { { "LPF", 6000.0f }, { "VOL", 12.0f }, { "OSFACTOR", 2.0f } } },
+        { "Clean Ceiling",  { { "FMODE", 2.0f }, { "LPF", 20000.0f }, { "VOL", 6.0f }, { "CLIPMODE", 1.0f } } }
+    };
+}
+
+//==============================================================================
+void PresetBank::initialise (const juce::Array<juce::AudioProcessorParameter*>& newParameters)
+{
+    parameters.clearQuick();
+
+    for (auto* parameter : newParameters)
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter);
+        jassert (ranged != nullptr);   // every parameter needs a range to be stored in a preset
+        parameters.add (ranged);
+    }
+
+    presets.clear();
+    presets.reserve ((size_t) maxNumPresets);
+    numPresets = 0;
+
+    for (auto& factoryPreset : factoryPresets)
+    {
+        StateFormat::ParameterValues values;
+
+        for (auto& value : factoryPreset.values)
+            values.emplace_back (value.first, value.second);
+
+        add (factoryPreset.name, values);
+    }
+}
+
+bool PresetBank::add (const juce::String& name, const StateFormat::ParameterValues& values)
+{
+    if (size() >= maxNumPresets)
+        return false;
+
+    Preset preset;
+    preset.name = name;
+    preset.values.reserve ((size_t) parameters.size());
+    preset.plainValues.reserve ((size_t) parameters.size());
+
+    for (auto* parameter : parameters)
+    {
+        auto newValue = parameter != nullptr ? parameter->getDefaultValue() : 0.0f;
+
+        for (auto& value : values)
+            if (parameter != nullptr && value.first == parameter->paramID)
+                newValue = parameter->convertTo0to1 (value.second);
+
+        preset.values.push_back (newValue);
+        preset.plainValues.push_back (parameter != nullptr ? parameter->convertFrom0to1 (newValue) : 0.0f);
+    }
+
+    //written in place before the count makes it visible to other threads
+    presets.push_back (std::move (preset));
+    numPresets = (int) presets.size();
+    return true;
+}
+
+void PresetBank::setName (int index, const juce::String& newName)
+{
+    if (juce::isPositiveAndBelow (index, size()))
+        presets[(size_t) index].name = newName;
+}
+
+//==============================================================================
+bool PresetBank::loadBank (const juce::File& file)
+{
+    //large banks are read in place rather than copied into memory first
+    juce::MemoryMappedFile mappedFile (file, juce::MemoryMappedFile::readOnly);
+
+    auto* data = static_cast<const char*> (mappedFile.getData());
+    auto sizeInBytes = mappedFile.getSize();
+
+    if (data == nullptr)
+        return false;
+
+    juce::MemoryInputStream stream (data, sizeInBytes, false);
+
+    if (stream.getNumBytesRemaining() < 8 || (juce::uint32) stream.readInt() != magic)
+        return false;
+
+    auto version = (int) (juce::uint16) stream.readShort();
+    auto numPresets = (int) (juce::uint16) stream.readShort();
+
+    if (version < 1 || version > currentVersion || size() + numPresets > maxNumPresets)
+        return false;
+
+    //the whole bank is validated before any of it is added
+    std::vector<std::pair<juce::String, StateFormat::ParameterValues>> loaded;
+    loaded.reserve ((size_t) numPresets);
+
+    for (int i = 0; i < numPresets; ++i)
+    {
+        if (stream.getNumBytesRemaining() < 1)
+            return false;
+
+        auto nameLength = (int) (juce::uint8) stream.readByte();
+
+        if (stream.getNumBytesRemaining() < nameLength + 4)
+            return false;
+
+        auto name = juce::String::fromUTF8 (data + stream.getPosition(), nameLength);
+        stream.skipNextBytes (nameLength);
+
+        auto stateSize = (juce::int64) (juce::uint32) stream.readInt();
+
+        if (stream.getNumBytesRemaining() < stateSize)
+            return false;
+
+        StateFormat::ParameterValues values;
+
+        if (! StateFormat::read (data + stream.getPosition(), (int) stateSize, {}, values))
+            return false;
+
+        stream.skipNextBytes (stateSize);
+        loaded.emplace_back (name, std::move (values));
+    }
+
+    if (! stream.isExhausted())
+        return false;
+
+    for (auto& preset : loaded)
+        add (preset.first, preset.second);
+
+    return true;
+}
+
+bool PresetBank::writeBank (const juce::File& file,
+                            const std::vector<std::pair<juce::String, StateFormat::ParameterValues>>& presetsToWrite)
+{
+    jassert (presetsToWrite.size() <= 0xffff);
+    auto numPresets = juce::jmin ((int) presetsToWrite.size(), 0xffff);
+
+    juce::MemoryOutputStream stream;
+    stream.writeInt ((int) magic);
+    stream.writeShort ((short) currentVersion);
+    stream.writeShort ((short) numPresets);
+
+    for (int i = 0; i < numPresets; ++i)
+    {
+        auto& preset = presetsToWrite[(size_t) i];
+
+        //names too long for the length byte are cut at a character boundary
+        auto name = preset.first;
+
+        while (name.getNumBytesAsUTF8() > 255)
+            name = name.dropLastCharacters (1);
+
+        juce::MemoryBlock state;
+        StateFormat::write (preset.second, state);
+
+        stream.writeByte ((char) name.getNumBytesAsUTF8());
+        stream.write (name.toRawUTF8(), name.getNumBytesAsUTF8());
+        stream.writeInt ((int) state.getSize());
+        stream << state;
+    }
+
+    return file.replaceWithData (stream.getData(), stream.getDataSize());
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+    The processor's programs: the factory presets plus any bank files added
+    with loadBank(). Every preset is resolved once, when it is added, to the
+    value of each parameter in the processor's parameter order, so switching
+    programs never has to look anything up by name. Presets are never moved
+    once added, so the audio thread can read any index below size() while
+    the message thread adds more.
+
+    Bank file layout (little-endian), memory-mapped while it is read:
+
+        uint32  magic "NPBK"
+        uint16  format version
+        uint16  number of presets
+        then per preset:
+            uint8    length of the name
+            char[]   name, UTF-8, not terminated
+            uint32   size of the state
+            uint8[]  state, as written by StateFormat::write()
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StateFormat.h"
+
+//==============================================================================
+/**
+*/
+class PresetBank
+{
+public:
+    PresetBank() = default;
+
+    struct Preset
+    {
+        juce::String name;
+        std::vector<float> values;        // normalised, one per parameter in parameter order
+        std::vector<float> plainValues;   // the same in the parameters' own units, for the DSP
+    };
+
+    static constexpr int maxNumPresets = 1024;
+
+    /** Keeps the parameters to resolve presets against and adds the factory presets. */
+    void initialise (const juce::Array<juce::AudioProcessorParameter*>& parameters);
+
+    /** Adds a preset given in the parameters' own units; missing parameters get
+        their default value. Returns false once the bank holds maxNumPresets.
+    */
+    bool add (const juce::String& name, const StateFormat::ParameterValues& values);
+
+    /** Adds every preset of a bank file. Returns false, adding nothing, if the
+        file can't be mapped, is malformed or doesn't fit.
+    */
+    bool loadBank (const juce::File& file);
+
+    /** Writes presets, given in the parameters' own units, as a bank file. */
+    static bool writeBank (const juce::File& file,
+                           const std::vector<std::pair<juce::String, StateFormat::ParameterValues>>& presets);
+
+    int size() const noexcept                           { return numPresets.load(); }
+    const Preset& operator[] (int index) const noexcept { return presets[(size_t) index]; }
+
+    void setName (int index, const juce::String& newName);
+
+private:
+    juce::Array<juce::RangedAudioParameter*> parameters;
+    std::vector<Preset> presets;   // reserved for maxNumPresets up front, so it never reallocates
+    std::atomic<int> numPresets { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    SharedResources.cpp
+
+  ==============================================================================
+*/
+
+#include "SharedResources.h"
+
+//==============================================================================
+juce::LookAndFeel& SharedResources::getLookAndFeel (int style)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    style = juce::jlimit ((int) darkStyle, (int) juce3Style, style);
+    auto& lookAndFeel = lookAndFeels[style - darkStyle];
+
+    if (lookAndFeel == nullptr)
+    {
+        if (style == juce4Style)
+        {
+            lookAndFeel = std::make_unique<juce::LookAndFeel_V3>();
+        }
+        else if (style == juce3Style)
+        {
+            lookAndFeel = std::make_unique<juce::LookAndFeel_V2>();
+        }
+        else
+        {
+            auto scheme = style == midnightStyle ? juce::LookAndFeel_V4::getMidnightColourScheme()
+                        : style == greyStyle     ? juce::LookAndFeel_V4::getGreyColourScheme()
+                        : style == lightStyle    ? juce::LookAndFeel_V4::getLightColourScheme()
+                                                 : juce::LookAndFeel_V4::getDarkColourScheme();
+
+            lookAndFeel = std::make_unique<juce::LookAndFeel_V4> (scheme);
+        }
+    }
+
+    return *lookAndFeel;
+}
+
+juce::Font SharedResources::getMonospacedFont (float height)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    //copies share the typeface, so it's only looked up once
+    return monospacedFont.withHeight (height);
+}
+
+juce::Image SharedResources::getImage (const juce::String& key, const std::function<juce::Image()>& render)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    auto found = images.find (key);
+
+    if (found != images.end())
+        return found->second;
+
+    //the map's own reference is the only one left
+    for (auto it = images.begin(); it != images.end();)
+        it = it->second.getReferenceCount() <= 1 ? images.erase (it) : std::next (it);
+
+    auto image = render();
+    images[key] = image;
+    return image;
+}
+
+//==============================================================================
+const std::vector<double>& SharedResources::getBlackmanHarrisWindow (int length)
+{
+    const juce::ScopedLock sl (tableLock);
+
+    auto& window = blackmanHarrisWindows[length];
+
+    if (window == nullptr)
+    {
+        auto values = std::make_unique<std::vector<double>> ((size_t) juce::jmax (0, length), 1.0);
+
+        for (int n = 0; length > 1 && n < length; ++n)
+        {
+            auto w = juce::MathConstants<double>::twoPi * n / (length - 1);
+            (*values)[(size_t) n] = 0.35875 - 0.48829 * std::cos (w) + 0.14128 * std::cos (2.0 * w) - 0.01168 * std::cos (3.0 * w);
+        }
+
+        window = std::move (values);
+    }
+
+    return *window;
+}
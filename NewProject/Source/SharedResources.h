@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    SharedResources.h
+
+    Everything that is the same for every instance in the process: the
+    editor's look-and-feels, fonts, rendered images and read-only DSP
+    tables. Hold it through juce::SharedResourcePointer<SharedResources>;
+    it is created with the first pointer and deleted with the last, and
+    each resource inside is only made the first time it's asked for, so a
+    session with hundreds of instances pays for one copy of what is in use.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class SharedResources
+{
+public:
+    SharedResources() = default;
+
+    //the editor's look-and-feel menu ids
+    enum Style
+    {
+        darkStyle = 1,
+        midnightStyle,
+        greyStyle,
+        lightStyle,
+        juce4Style,
+        juce3Style
+    };
+
+    /** Message thread. Created on first use and kept while any instance is alive. */
+    juce::LookAndFeel& getLookAndFeel (int style);
+
+    /** Message thread. */
+    juce::Font getMonospacedFont (float height);
+
+    /** Message thread. The image stored under key, or the result of render()
+        if there isn't one. Images nobody else holds any more are dropped
+        whenever a new one is added.
+    */
+    juce::Image getImage (const juce::String& key, const std::function<juce::Image()>& render);
+
+    /** Any thread. A symmetric Blackman-Harris window of length points, computed
+        once per length and never changed afterwards.
+    */
+    const std::vector<double>& getBlackmanHarrisWindow (int length);
+
+private:
+    std::unique_ptr<juce::LookAndFeel> lookAndFeels[juce3Style];
+    juce::Font monospacedFont { juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain };
+
+    std::map<juce::String, juce::Image> images;
+
+    juce::CriticalSection tableLock;
+    std::map<int, std::unique_ptr<const std::vector<double>>> blackmanHarrisWindows;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedResources)
+};
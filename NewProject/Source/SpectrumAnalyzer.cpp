@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : juce::Thread ("Spectrum analyzer")
+{
+    // symmetric Hann, normalised below so a full-scale sine reads 0 dB
+    window.resize ((size_t) fftSize);
+    auto windowSum = 0.0f;
+
+    for (int n = 0; n < fftSize; ++n)
+    {
+        window[(size_t) n] = 0.5f - 0.5f * std::cos (juce::MathConstants<float>::twoPi * (float) n / (float) (fftSize - 1));
+        windowSum += window[(size_t) n];
+    }
+
+    magnitudeScale = 2.0f / windowSum;
+    fftData.resize ((size_t) (2 * fftSize));
+
+    for (auto& signal : signals)
+        signal.history.resize ((size_t) fftSize);
+
+    clearAnalysis();
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    release();
+}
+
+float SpectrumAnalyzer::getBandFrequency (int band) noexcept
+{
+    return minFrequency * std::pow (maxFrequency / minFrequency, (float) band / (float) (numBands - 1));
+}
+
+void SpectrumAnalyzer::prepare (double newSampleRate, int numChannels)
+{
+    release();
+
+    sampleRate = newSampleRate;
+    numChannelsPrepared = juce::jmax (1, numChannels);
+
+    // a quarter of a second of headroom in case the thread gets descheduled
+    auto capacity = juce::jmax (2 * hopSize, juce::roundToInt (sampleRate * 0.25));
+
+    for (auto& signal : signals)
+        signal.fifo.prepare (numChannelsPrepared, capacity);
+
+    readBuffer.setSize (numChannelsPrepared, hopSize);
+
+    // each band takes the loudest bin between the geometric midpoints to its
+    // neighbours, so a sine shows its true level whichever band it falls in
+    auto binWidth = (float) (sampleRate / fftSize);
+    auto bandRatio = std::pow (maxFrequency / minFrequency, 0.5f / (float) (numBands - 1));
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto frequency = getBandFrequency (band);
+
+        firstBin[(size_t) band] = juce::jlimit (1, fftSize / 2, (int) std::ceil (frequency / bandRatio / binWidth));
+        lastBin[(size_t) band] = juce::jlimit (0, fftSize / 2, (int) std::floor (frequency * bandRatio / binWidth));
+        centreBin[(size_t) band] = juce::jlimit (0.0f, (float) (fftSize / 2 - 1), frequency / binWidth);
+    }
+
+    // falls 20 dB in a second
+    releasePerFrame = 20.0f * (float) hopSize / (float) sampleRate;
+
+    startIfReady();
+}
+
+void SpectrumAnalyzer::release()
+{
+    stopThread (1000);
+}
+
+void SpectrumAnalyzer::setEnabled (bool shouldBeEnabled)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (shouldBeEnabled == enabled.load())
+        return;
+
+    enabled = shouldBeEnabled;
+
+    if (shouldBeEnabled)
+        startIfReady();
+    else
+        release();
+}
+
+void SpectrumAnalyzer::startIfReady()
+{
+    if (enabled.load() && sampleRate > 0.0)
+        startThread();
+}
+
+//==============================================================================
+void SpectrumAnalyzer::run()
+{
+    // anything queued before the last stop is stale
+    for (auto& signal : signals)
+        signal.fifo.discard();
+
+    clearAnalysis();
+
+    while (! threadShouldExit())
+    {
+        readAndAnalyse (signals[0]);
+
+        // the output is analysed last, so a frame holds both sides of the same hop
+        if (readAndAnalyse (signals[1]))
+            publish();
+        else
+            wait (10);
+    }
+}
+
+void SpectrumAnalyzer::clearAnalysis()
+{
+    for (auto& signal : signals)
+    {
+        std::fill (signal.history.begin(), signal.history.end(), 0.0f);
+        signal.numNewSamples = 0;
+        signal.levels.fill ((float) minDecibels);
+    }
+}
+
+bool SpectrumAnalyzer::readAndAnalyse (Signal& signal)
+{
+    auto hasAnalysed = false;
+
+    for (;;)
+    {
+        auto numRead = signal.fifo.pop (readBuffer, hopSize - signal.numNewSamples);
+
+        if (numRead <= 0)
+            return hasAnalysed;
+
+        // slide the history along and append the new samples, summed to mono
+        auto& history = signal.history;
+        std::copy (history.begin() + numRead, history.end(), history.begin());
+
+        auto* dest = history.data() + fftSize - numRead;
+        juce::FloatVectorOperations::copyWithMultiply (dest, readBuffer.getReadPointer (0), 1.0f / (float) numChannelsPrepared, numRead);
+
+        for (int channel = 1; channel < numChannelsPrepared; ++channel)
+            juce::FloatVectorOperations::addWithMultiply (dest, readBuffer.getReadPointer (channel), 1.0f / (float) numChannelsPrepared, numRead);
+
+        signal.numNewSamples += numRead;
+
+        if (signal.numNewSamples == hopSize)
+        {
+            analyse (signal);
+            signal.numNewSamples = 0;
+            hasAnalysed = true;
+        }
+    }
+}
+
+void SpectrumAnalyzer::analyse (Signal& signal)
+{
+    juce::FloatVectorOperations::multiply (fftData.data(), signal.history.data(), window.data(), fftSize);
+    fft.performFrequencyOnlyForwardTransform (fftData.data());
+
+    const auto* magnitudes = fftData.data();
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        auto magnitude = 0.0f;
+
+        if (lastBin[(size_t) band] >= firstBin[(size_t) band])
+        {
+            for (int bin = firstBin[(size_t) band]; bin <= lastBin[(size_t) band]; ++bin)
+                magnitude = juce::jmax (magnitude, magnitudes[bin]);
+        }
+        else
+        {
+            auto bin = (int) centreBin[(size_t) band];
+            auto fraction = centreBin[(size_t) band] - (float) bin;
+            magnitude = magnitudes[bin] + (magnitudes[bin + 1] - magnitudes[bin]) * fraction;
+        }
+
+        // instant attack, linear fall in dB
+        auto level = juce::Decibels::gainToDecibels (magnitude * magnitudeScale, minDecibels);
+        auto& shown = signal.levels[(size_t) band];
+        shown = juce::jmax (level, shown - releasePerFrame);
+    }
+}
+
+//==============================================================================
+void SpectrumAnalyzer::publish()
+{
+    auto& frame = frames[backIndex];
+    frame.input = signals[0].levels;
+    frame.output = signals[1].levels;
+
+    backIndex = sharedIndex.exchange (backIndex | newFrameFlag) & ~newFrameFlag;
+}
+
+bool SpectrumAnalyzer::getNextFrame (Frame& dest) noexcept
+{
+    if ((sharedIndex.load() & newFrameFlag) == 0)
+        return false;
+
+    frontIndex = sharedIndex.exchange (frontIndex) & ~newFrameFlag;
+    dest = frames[frontIndex];
+    return true;
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Spectrum of the processor's input and output, for the editor's display.
+
+    The audio thread only copies both into AudioSampleFifos, and only while
+    the analyzer is enabled, which the editor does for as long as it is open.
+    Windowed FFTs, band binning on a log frequency axis and ballistics run on
+    the analyzer's own thread, which is not running at all otherwise. Frames
+    reach the editor through a lock-free triple buffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioSampleFifo.h"
+
+//==============================================================================
+/**
+*/
+class SpectrumAnalyzer  : private juce::Thread
+{
+public:
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer() override;
+
+    static constexpr int numBands = 256;
+    static constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+    static constexpr float minDecibels = -100.0f;
+
+    /** Smoothed level in dB of each band, bands log-spaced from minFrequency to
+        maxFrequency, with 0 dB for a full-scale sine.
+    */
+    struct Frame
+    {
+        std::array<float, numBands> input, output;
+    };
+
+    /** Centre frequency of a band. */
+    static float getBandFrequency (int band) noexcept;
+
+    /** Stops the analysis and allocates for the new format. It starts again if
+        the analyzer is enabled. Must not be called from the audio thread.
+    */
+    void prepare (double sampleRate, int numChannels);
+
+    /** Stops the analysis thread. */
+    void release();
+
+    /** Message thread. While disabled nothing is queued or analysed. */
+    void setEnabled (bool shouldBeEnabled);
+
+    /** Audio thread. Copies the block into the analysis queue, if enabled. */
+    template <typename SampleType>
+    void pushInput (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (enabled.load (std::memory_order_relaxed))
+            signals[0].fifo.push (channels, numChannels, numSamples);
+    }
+
+    template <typename SampleType>
+    void pushOutput (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (enabled.load (std::memory_order_relaxed))
+            signals[1].fifo.push (channels, numChannels, numSamples);
+    }
+
+    /** A single reader on any thread. Copies the newest frame into dest and
+        returns true, or returns false if there's none since the last call.
+    */
+    bool getNextFrame (Frame& dest) noexcept;
+
+private:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+
+    struct Signal
+    {
+        AudioSampleFifo fifo;
+        std::vector<float> history;    // the last fftSize samples, summed to mono
+        int numNewSamples = 0;
+        std::array<float, numBands> levels;
+    };
+
+    void run() override;
+    void startIfReady();
+    void clearAnalysis();
+    bool readAndAnalyse (Signal& signal);
+    void analyse (Signal& signal);
+    void publish();
+
+    double sampleRate = 0.0;
+    int numChannelsPrepared = 0;
+    std::atomic<bool> enabled { false };
+
+    Signal signals[2];   // input, output
+
+    // analysis thread only
+    juce::dsp::FFT fft { fftOrder };
+    std::vector<float> window, fftData;
+    juce::AudioBuffer<float> readBuffer;
+    float magnitudeScale = 1.0f, releasePerFrame = 0.0f;
+
+    // bins that feed each band; bands narrower than a bin interpolate at centreBin
+    std::array<int, numBands> firstBin, lastBin;
+    std::array<float, numBands> centreBin;
+
+    // triple buffer: the writer fills backIndex, the reader owns frontIndex, and
+    // the third is swapped through sharedIndex with newFrameFlag set when it is newer
+    static constexpr int newFrameFlag = 4;
+    Frame frames[3];
+    int backIndex = 0, frontIndex = 1;
+    std::atomic<int> sharedIndex { 2 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzer)
+};
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay()
+{
+    frame.input.fill ((float) SpectrumAnalyzer::minDecibels);
+    frame.output.fill ((float) SpectrumAnalyzer::minDecibels);
+    response.fill (0.0f);
+
+    setOpaque (true);
+}
+
+void SpectrumDisplay::setFrame (const SpectrumAnalyzer::Frame& newFrame)
+{
+    frame = newFrame;
+
+    inputPath = createCurve (frame.input.data(), true);
+    outputPath = createCurve (frame.output.data(), true);
+    repaint();
+}
+
+void SpectrumDisplay::setFilterResponse (const float* decibelsPerBand)
+{
+    std::copy (decibelsPerBand, decibelsPerBand + SpectrumAnalyzer::numBands, response.begin());
+
+    updateResponsePath();
+    repaint();
+}
+
+void SpectrumDisplay::resized()
+{
+    inputPath = createCurve (frame.input.data(), true);
+    outputPath = createCurve (frame.output.data(), true);
+    updateResponsePath();
+}
+
+void SpectrumDisplay::updateResponsePath()
+{
+    //stroked once here, so every repaint for a new frame only fills it
+    responsePath.clear();
+    juce::PathStrokeType (1.5f).createStrokedPath (responsePath, createCurve (response.data(), false));
+}
+
+//==============================================================================
+float SpectrumDisplay::getXForBand (int band) const noexcept
+{
+    // bands are evenly spaced on the log axis
+    return (float) getWidth() * (float) band / (float) (SpectrumAnalyzer::numBands - 1);
+}
+
+float SpectrumDisplay::getYForDecibels (float decibels) const noexcept
+{
+    return juce::jmap (juce::jlimit (minDecibels, maxDecibels, decibels), maxDecibels, minDecibels, 0.0f, (float) getHeight());
+}
+
+juce::Path SpectrumDisplay::createCurve (const float* decibelsPerBand, bool closeAtBottom) const
+{
+    juce::Path path;
+
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return path;
+
+    // bands that land in the same pixel column become one point, at their loudest
+    auto bottom = (float) getHeight();
+    auto column = -1;
+    auto loudest = minDecibels;
+
+    auto addPoint = [&] (float x, float decibels)
+    {
+        if (path.isEmpty())
+        {
+            if (closeAtBottom)
+            {
+                path.startNewSubPath (x, bottom);
+                path.lineTo (x, getYForDecibels (decibels));
+            }
+            else
+            {
+                path.startNewSubPath (x, getYForDecibels (decibels));
+            }
+        }
+        else
+        {
+            path.lineTo (x, getYForDecibels (decibels));
+        }
+    };
+
+    for (int band = 0; band < SpectrumAnalyzer::numBands; ++band)
+    {
+        auto x = getXForBand (band);
+        auto bandColumn = (int) x;
+
+        if (bandColumn != column && column >= 0)
+        {
+            addPoint ((float) column, loudest);
+            loudest = minDecibels;
+        }
+
+        column = bandColumn;
+        loudest = juce::jmax (loudest, decibelsPerBand[band]);
+    }
+
+    addPoint ((float) getWidth(), loudest);
+
+    if (closeAtBottom)
+    {
+        path.lineTo ((float) getWidth(), bottom);
+        path.closeSubPath();
+    }
+
+    return path;
+}
+
+void SpectrumDisplay::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+
+    // decades and the 0 dB line
+    g.setColour (juce::Colours::white.withAlpha (0.15f));
+
+    for (auto frequency : { 100.0f, 1000.0f, 10000.0f })
+    {
+        auto position = std::log (frequency / SpectrumAnalyzer::minFrequency)
+                          / std::log (SpectrumAnalyzer::maxFrequency / SpectrumAnalyzer::minFrequency);
+        g.drawVerticalLine (juce::roundToInt (position * (float) getWidth()), 0.0f, (float) getHeight());
+    }
+
+    g.drawHorizontalLine (juce::roundToInt (getYForDecibels (0.0f)), 0.0f, (float) getWidth());
+
+    g.setColour (juce::Colours::grey.withAlpha (0.5f));
+    g.fillPath (inputPath);
+
+    g.setColour (juce::Colours::limegreen.withAlpha (0.6f));
+    g.fillPath (outputPath);
+
+    g.setColour (juce::Colours::orange);
+    g.fillPath (responsePath);
+}
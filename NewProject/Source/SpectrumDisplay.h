@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.h
+
+    Input and output spectrum from the SpectrumAnalyzer, with the filter's
+    magnitude response on top. The curves are kept as Paths with at most one
+    point per pixel column, rebuilt only when a new frame or response comes
+    in or the size changes; paint() only fills them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+/**
+*/
+class SpectrumDisplay  : public juce::Component
+{
+public:
+    SpectrumDisplay();
+
+    static constexpr float minDecibels = -96.0f, maxDecibels = 12.0f;
+
+    /** Takes the newest frame from the analyzer. */
+    void setFrame (const SpectrumAnalyzer::Frame& newFrame);
+
+    /** Magnitude of the filter in dB at each SpectrumAnalyzer band frequency. */
+    void setFilterResponse (const float* decibelsPerBand);
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    float getXForBand (int band) const noexcept;
+    float getYForDecibels (float decibels) const noexcept;
+    juce::Path createCurve (const float* decibelsPerBand, bool closeAtBottom) const;
+    void updateResponsePath();
+
+    SpectrumAnalyzer::Frame frame;
+    std::array<float, SpectrumAnalyzer::numBands> response;
+
+    juce::Path inputPath, outputPath;
+    juce::Path responsePath;   // already stroked
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumDisplay)
+};
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    StateFormat.cpp
+
+  ==============================================================================
+*/
+
+#include "StateFormat.h"
+
+namespace
+{
+    constexpr juce::uint32 magic = 0x5453504e;   // "NPST" when read as bytes
+
+    bool readBinary (const void* data, int sizeInBytes, StateFormat::ParameterValues& values)
+    {
+        juce::MemoryInputStream stream (data, (size_t) sizeInBytes, false);
+
+        if (stream.getNumBytesRemaining() < 8 || (juce::uint32) stream.readInt() != magic)
+            return false;
+
+        auto version = (int) (juce::uint16) stream.readShort();
+        auto numParameters = (int) (juce::uint16) stream.readShort();
+
+        if (version < 1 || version > StateFormat::currentVersion)
+            return false;
+
+        values.reserve ((size_t) numParameters);
+
+        for (int i = 0; i < numParameters; ++i)
+        {
+            if (stream.getNumBytesRemaining() < 1)
+                return false;
+
+            auto idLength = (int) (juce::uint8) stream.readByte();
+
+            if (idLength == 0 || stream.getNumBytesRemaining() < idLength + 4)
+                return false;
+
+            auto* idStart = static_cast<const char*> (data) + stream.getPosition();
+            auto id = juce::String::fromUTF8 (idStart, idLength);
+            stream.skipNextBytes (idLength);
+
+            auto value = stream.readFloat();
+
+            if (! std::isfinite (value))
+                return false;
+
+            values.emplace_back (id, value);
+        }
+
+        return stream.isExhausted();
+    }
+
+    bool readLegacyXml (const void* data, int sizeInBytes, const juce::Identifier& stateType,
+                        StateFormat::ParameterValues& values)
+    {
+        auto xml = juce::AudioProcessor::getXmlFromBinary (data, sizeInBytes);
+
+        if (xml == nullptr || ! xml->hasTagName (stateType.toString()))
+            return false;
+
+        // AudioProcessorValueTreeState writes one <PARAM id="..." value="..."/> per parameter
+        for (auto* param : xml->getChildWithTagNameIterator ("PARAM"))
+        {
+            auto id = param->getStringAttribute ("id");
+
+            if (id.isEmpty() || ! param->hasAttribute ("value"))
+                return false;
+
+            auto value = (float) param->getDoubleAttribute ("value");
+
+            if (! std::isfinite (value))
+                return false;
+
+            values.emplace_back (id, value);
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+void StateFormat::write (const ParameterValues& values, juce::MemoryBlock& destData)
+{
+    juce::MemoryOutputStream stream (destData, false);
+
+    stream.writeInt ((int) magic);
+    stream.writeShort ((short) currentVersion);
+    stream.writeShort ((short) juce::jmin ((int) values.size(), 0xffff));
+
+    for (auto& value : values)
+    {
+        auto id = value.first.toRawUTF8();
+        auto idLength = juce::jlimit (1, 255, (int) std::strlen (id));
+        jassert (idLength == (int) std::strlen (id));   // parameter IDs must fit in a byte
+
+        stream.writeByte ((char) idLength);
+        stream.write (id, (size_t) idLength);
+        stream.writeFloat (value.second);
+    }
+}
+
+bool StateFormat::read (const void* data, int sizeInBytes, const juce::Identifier& legacyStateType,
+                        ParameterValues& values)
+{
+    values.clear();
+
+    if (data == nullptr || sizeInBytes <= 0)
+        return false;
+
+    if (readBinary (data, sizeInBytes, values))
+        return true;
+
+    values.clear();
+
+    if (readLegacyXml (data, sizeInBytes, legacyStateType, values))
+        return true;
+
+    values.clear();
+    return false;
+}
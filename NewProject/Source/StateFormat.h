@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    StateFormat.h
+
+    Compact, versioned binary encoding of the plugin state, read without any
+    XML parsing. Layout (little-endian):
+
+        uint32  magic "NPST"
+        uint16  format version
+        uint16  number of parameters
+        then per parameter:
+            uint8    length of the parameter ID
+            char[]   parameter ID, UTF-8, not terminated
+            float32  value in the parameter's own units (Hz, dB, choice index...)
+
+    Values are stored by ID in real-world units, so adding, removing,
+    reordering or re-ranging parameters keeps old sessions loadable.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace StateFormat
+{
+    /** Parameter ID and value, in the parameter's own units. */
+    using ParameterValues = std::vector<std::pair<juce::String, float>>;
+
+    constexpr int currentVersion = 1;
+
+    /** Writes values in the current binary format. */
+    void write (const ParameterValues& values, juce::MemoryBlock& destData);
+
+    /** Reads the binary format, or a legacy copyXmlToBinary() blob of an
+        AudioProcessorValueTreeState whose state type is legacyStateType.
+
+        The whole blob is validated before anything is returned: truncated
+        data, a newer format version, a foreign XML document or a value that
+        is not finite make it return false with values left empty.
+    */
+    bool read (const void* data, int sizeInBytes, const juce::Identifier& legacyStateType,
+               ParameterValues& values);
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    TruePeakDetector.cpp
+
+  ==============================================================================
+*/
+
+#include "TruePeakDetector.h"
+
+namespace
+{
+    constexpr int numTaps = TruePeakDetector::oversamplingFactor * TruePeakDetector::tapsPerPhase;
+
+    /** Windowed-sinc interpolation filter, split into unity-gain phases. */
+    struct InterpolatorTable
+    {
+        InterpolatorTable()
+        {
+            const auto factor = (double) TruePeakDetector::oversamplingFactor;
+            const auto centre = (numTaps - 1) * 0.5;
+            double taps[numTaps];
+
+            for (int n = 0; n < numTaps; ++n)
+            {
+                auto x = ((double) n - centre) / factor;
+                auto sinc = std::abs (x) < 1.0e-9 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+
+                // 4-term Blackman-Harris
+                auto w = juce::MathConstants<double>::twoPi * (n + 0.5) / numTaps;
+                auto window = 0.35875 - 0.48829 * std::cos (w) + 0.14128 * std::cos (2.0 * w) - 0.01168 * std::cos (3.0 * w);
+
+                taps[n] = sinc * window;
+            }
+
+            for (int phase = 0; phase < TruePeakDetector::oversamplingFactor; ++phase)
+            {
+                auto sum = 0.0;
+
+                for (int k = 0; k < TruePeakDetector::tapsPerPhase; ++k)
+                    sum += taps[k * TruePeakDetector::oversamplingFactor + phase];
+
+                for (int k = 0; k < TruePeakDetector::tapsPerPhase; ++k)
+                    coefficients[phase * TruePeakDetector::tapsPerPhase + k] = (float) (taps[k * TruePeakDetector::oversamplingFactor + phase] / sum);
+            }
+        }
+
+        float coefficients[numTaps];
+    };
+
+    const float* getInterpolatorTable()
+    {
+        static const InterpolatorTable table;
+        return table.coefficients;
+    }
+}
+
+//==============================================================================
+TruePeakDetector::TruePeakDetector()
+    : coefficients (getInterpolatorTable())
+{
+}
+
+void TruePeakDetector::reset() noexcept
+{
+    std::fill (std::begin (history), std::end (history), 0.0f);
+    position = 0;
+}
+
+float TruePeakDetector::processSample (float sample) noexcept
+{
+    position = (position + tapsPerPhase - 1) % tapsPerPhase;
+    history[position] = sample;
+    history[position + tapsPerPhase] = sample;
+
+    const auto* recent = history + position;   // recent[k] is the input k samples ago
+    auto peak = 0.0f;
+
+    for (int phase = 0; phase < oversamplingFactor; ++phase)
+    {
+        const auto* phaseCoefficients = coefficients + phase * tapsPerPhase;
+        auto value = 0.0f;
+
+        for (int k = 0; k < tapsPerPhase; ++k)
+            value += phaseCoefficients[k] * recent[k];
+
+        peak = juce::jmax (peak, std::abs (value));
+    }
+
+    return peak;
+}
+
+template <typename SampleType>
+float TruePeakDetector::process (const SampleType* data, int numSamples) noexcept
+{
+    auto peak = 0.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+        peak = juce::jmax (peak, processSample ((float) data[i]));
+
+    return peak;
+}
+
+//==============================================================================
+template float TruePeakDetector::process<float>  (const float*,  int) noexcept;
+template float TruePeakDetector::process<double> (const double*, int) noexcept;
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    TruePeakDetector.h
+
+    Inter-sample peak estimate as described in ITU-R BS.1770 Annex 2: the
+    signal is interpolated 4x with a 48-tap polyphase FIR and the largest
+    absolute value of the interpolated samples is taken.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class TruePeakDetector
+{
+public:
+    TruePeakDetector();
+
+    static constexpr int oversamplingFactor = 4;
+    static constexpr int tapsPerPhase = 12;
+
+    /** Delay of the interpolated signal relative to the input, in input samples. */
+    static constexpr int latencyInSamples = tapsPerPhase / 2;
+
+    /** Clears the interpolator history. */
+    void reset() noexcept;
+
+    /** Feeds one channel's samples and returns the largest absolute value of the
+        4x interpolated signal over them.
+    */
+    template <typename SampleType>
+    float process (const SampleType* data, int numSamples) noexcept;
+
+    /** Feeds one sample and returns the largest absolute interpolated value between
+        the previous sample and this one.
+    */
+    float processSample (float sample) noexcept;
+
+private:
+    // the most recent input is at history[position] and again at
+    // history[position + tapsPerPhase], so a phase is one contiguous dot product
+    float history[2 * tapsPerPhase] = {};
+    int position = 0;
+
+    const float* coefficients;   // [phase][tap], shared by every detector
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TruePeakDetector)
+};